@@ -0,0 +1,368 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+// Benchmark of polygon preparation, containment and segment intersection.
+// Build : g++ -std=c++11 -O2 -march=native -I../include geometry_bench.cpp
+// Usage : geometry_bench [max_nb_vertex]
+// Each measure is printed on stdout as a JSON object on its own line
+#include "polygon.hpp"
+#include "convex_shape.hpp"
+#include "segment.hpp"
+#include "polygon_generator.hpp"
+#include "convex_partition.hpp"
+#include "slab_decomposition.hpp"
+#include "raster_polygon.hpp"
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cinttypes>
+
+namespace geometry_bench
+{
+  typedef std::chrono::steady_clock t_clock;
+
+  // Prevent compiler from removing measured calls
+  volatile uint64_t g_sink = 0;
+
+  //----------------------------------------------------------------------------
+  inline double get_ns(const t_clock::time_point & p_start,const t_clock::time_point & p_end)
+  {
+    return std::chrono::duration<double,std::nano>(p_end - p_start).count();
+  }
+
+  // Deterministic pseudo random sequence so that runs are comparable
+  class lcg
+  {
+  public:
+    inline lcg(uint64_t p_seed):
+      m_state(p_seed)
+    {
+    }
+
+    inline double next(void)
+    {
+      m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return (m_state >> 11) * (1.0 / 9007199254740992.0);
+    }
+  private:
+    uint64_t m_state;
+  };
+
+  // One JSON object per line
+  class record
+  {
+  public:
+    inline record(const std::string & p_bench,const std::string & p_type,const std::string & p_shape,uint32_t p_nb_vertex)
+    {
+      m_stream << "{\"bench\":\"" << p_bench << "\",\"type\":\"" << p_type << "\",\"shape\":\"" << p_shape << "\",\"nb_vertex\":" << p_nb_vertex;
+    }
+
+    inline record & add(const std::string & p_name,double p_value)
+    {
+      m_stream << ",\"" << p_name << "\":" << p_value;
+      return *this;
+    }
+
+    inline ~record(void)
+    {
+      std::cout << m_stream.str() << "}" << std::endl;
+    }
+  private:
+    std::ostringstream m_stream;
+  };
+
+  template <typename T>
+  class runner
+  {
+  public:
+    inline runner(const std::string & p_type);
+    inline void run(const std::string & p_shape,const std::vector<geometry::point<T>> & p_points);
+    inline void run_convex(const std::vector<geometry::point<T>> & p_points);
+  private:
+    inline std::vector<geometry::point<T>> get_queries(const geometry::shape<T> & p_shape,uint32_t p_nb_query)const;
+    inline static uint32_t get_nb_query(uint32_t p_nb_vertex);
+    inline static void add_latency(record & p_record,std::vector<double> & p_latencies);
+
+    std::string m_type;
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  runner<T>::runner(const std::string & p_type):
+    m_type(p_type)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t runner<T>::get_nb_query(uint32_t p_nb_vertex)
+  {
+    // Bound total work as contains cost grows with vertex number
+    return std::max((uint32_t)100,std::min((uint32_t)100000,(uint32_t)(200000000 / p_nb_vertex)));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<geometry::point<T>> runner<T>::get_queries(const geometry::shape<T> & p_shape,uint32_t p_nb_query)const
+  {
+    lcg l_random(p_nb_query);
+    double l_width = (double)p_shape.get_max_x() - p_shape.get_min_x();
+    double l_height = (double)p_shape.get_max_y() - p_shape.get_min_y();
+    std::vector<geometry::point<T>> l_queries;
+    l_queries.reserve(p_nb_query);
+    for(uint32_t l_index = 0 ; l_index < p_nb_query ; ++l_index)
+      {
+        // Query box is 10% larger than shape box
+        double l_x = p_shape.get_min_x() + (l_random.next() * 1.1 - 0.05) * l_width;
+        double l_y = p_shape.get_min_y() + (l_random.next() * 1.1 - 0.05) * l_height;
+        l_queries.push_back(geometry::point<T>((T)l_x,(T)l_y));
+      }
+    return l_queries;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void runner<T>::add_latency(record & p_record,std::vector<double> & p_latencies)
+  {
+    double l_total = 0;
+    for(auto l_iter : p_latencies)
+      {
+        l_total += l_iter;
+      }
+    std::sort(p_latencies.begin(),p_latencies.end());
+    p_record.add("query_mean_ns",l_total / p_latencies.size());
+    p_record.add("query_p50_ns",p_latencies[p_latencies.size() / 2]);
+    p_record.add("query_p99_ns",p_latencies[(p_latencies.size() * 99) / 100]);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void runner<T>::run(const std::string & p_shape,const std::vector<geometry::point<T>> & p_points)
+  {
+    uint32_t l_nb_vertex = p_points.size();
+
+    // Preparation phases
+    t_clock::time_point l_start = t_clock::now();
+    geometry::polygon<T> l_polygon(p_points);
+    t_clock::time_point l_built = t_clock::now();
+    bool l_convex = l_polygon.is_convex();
+    t_clock::time_point l_wrapped = t_clock::now();
+    if(!l_convex)
+      {
+        l_polygon.cut_in_convex_polygon();
+      }
+    t_clock::time_point l_cut = t_clock::now();
+    record(std::string("prepare"),m_type,p_shape,l_nb_vertex)
+      .add("construct_ns",get_ns(l_start,l_built))
+      .add("is_convex_ns",get_ns(l_built,l_wrapped))
+      .add("cut_ns",get_ns(l_wrapped,l_cut));
+
+    // Single queries
+    std::vector<geometry::point<T>> l_queries = get_queries(l_polygon,get_nb_query(l_nb_vertex));
+    std::vector<double> l_latencies;
+    l_latencies.reserve(l_queries.size());
+    uint64_t l_nb_inside = 0;
+    for(auto & l_iter : l_queries)
+      {
+        t_clock::time_point l_query_start = t_clock::now();
+        bool l_inside = l_polygon.contains(l_iter);
+        l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+        l_nb_inside += l_inside;
+      }
+    g_sink += l_nb_inside;
+    {
+      record l_record(std::string("polygon_contains"),m_type,p_shape,l_nb_vertex);
+      l_record.add("nb_query",l_queries.size()).add("inside_ratio",((double)l_nb_inside) / l_queries.size());
+      add_latency(l_record,l_latencies);
+    }
+
+    // Same queries on triangulation based decomposition
+    l_start = t_clock::now();
+    geometry::convex_partition<T> l_partition(l_polygon);
+    double l_partition_ns = get_ns(l_start,t_clock::now());
+    l_latencies.clear();
+    l_nb_inside = 0;
+    for(auto & l_iter : l_queries)
+      {
+        t_clock::time_point l_query_start = t_clock::now();
+        bool l_inside = l_partition.contains(l_iter);
+        l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+        l_nb_inside += l_inside;
+      }
+    g_sink += l_nb_inside;
+    {
+      record l_record(std::string("partition_contains"),m_type,p_shape,l_nb_vertex);
+      l_record.add("prepare_ns",l_partition_ns).add("nb_piece",l_partition.get_nb_piece()).add("nb_query",l_queries.size()).add("inside_ratio",((double)l_nb_inside) / l_queries.size());
+      add_latency(l_record,l_latencies);
+    }
+
+    // Slab memory is quadratic for shapes like star or nested
+    if(l_nb_vertex <= 10000)
+      {
+        l_start = t_clock::now();
+        geometry::slab_decomposition<T> l_slabs(l_polygon);
+        double l_slabs_ns = get_ns(l_start,t_clock::now());
+        l_latencies.clear();
+        l_nb_inside = 0;
+        for(auto & l_iter : l_queries)
+          {
+            t_clock::time_point l_query_start = t_clock::now();
+            bool l_inside = l_slabs.contains(l_iter);
+            l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+            l_nb_inside += l_inside;
+          }
+        g_sink += l_nb_inside;
+        record l_record(std::string("slab_contains"),m_type,p_shape,l_nb_vertex);
+        l_record.add("prepare_ns",l_slabs_ns).add("nb_slab_edge",l_slabs.get_nb_slab_edge()).add("nb_query",l_queries.size()).add("inside_ratio",((double)l_nb_inside) / l_queries.size());
+        add_latency(l_record,l_latencies);
+      }
+
+    // Occupancy mask falling back on polygon in border cells
+    l_start = t_clock::now();
+    geometry::raster_polygon<T> l_raster(l_polygon,256,256);
+    double l_raster_ns = get_ns(l_start,t_clock::now());
+    l_latencies.clear();
+    l_nb_inside = 0;
+    for(auto & l_iter : l_queries)
+      {
+        t_clock::time_point l_query_start = t_clock::now();
+        bool l_inside = l_raster.contains(l_iter);
+        l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+        l_nb_inside += l_inside;
+      }
+    g_sink += l_nb_inside;
+    {
+      record l_record(std::string("raster_contains"),m_type,p_shape,l_nb_vertex);
+      l_record.add("prepare_ns",l_raster_ns).add("memory_bytes",l_raster.get_memory_size()).add("boundary_ratio",((double)l_raster.get_nb_cell(geometry::raster_polygon<T>::t_cell_state::BOUNDARY)) / (256 * 256)).add("nb_query",l_queries.size()).add("inside_ratio",((double)l_nb_inside) / l_queries.size());
+      add_latency(l_record,l_latencies);
+    }
+
+    // Border queries through grid border index
+    l_latencies.clear();
+    uint32_t l_nb_border = 0;
+    for(auto & l_iter : l_queries)
+      {
+        t_clock::time_point l_query_start = t_clock::now();
+        bool l_border = l_polygon.is_on_border(l_iter);
+        l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+        l_nb_border += l_border;
+      }
+    g_sink += l_nb_border;
+    {
+      record l_record(std::string("is_on_border"),m_type,p_shape,l_nb_vertex);
+      l_record.add("nb_query",l_queries.size()).add("border_ratio",((double)l_nb_border) / l_queries.size());
+      add_latency(l_record,l_latencies);
+    }
+
+    // Batch queries
+    std::vector<bool> l_result;
+    l_start = t_clock::now();
+    l_polygon.contains(l_queries.data(),l_queries.size(),l_result);
+    double l_batch_ns = get_ns(l_start,t_clock::now());
+    g_sink += std::count(l_result.begin(),l_result.end(),true);
+    record(std::string("polygon_batch_contains"),m_type,p_shape,l_nb_vertex)
+      .add("nb_query",l_queries.size())
+      .add("points_per_s",l_queries.size() * 1e9 / l_batch_ns);
+
+    // Intersection of random pairs of polygon edges
+    lcg l_random(l_nb_vertex);
+    uint32_t l_nb_pair = 1000000;
+    std::vector<uint32_t> l_pairs(2 * l_nb_pair);
+    for(auto & l_iter : l_pairs)
+      {
+        l_iter = std::min((uint32_t)(l_random.next() * l_nb_vertex),l_nb_vertex - 1);
+      }
+    uint64_t l_nb_intersection = 0;
+    l_start = t_clock::now();
+    for(uint32_t l_index = 0 ; l_index < l_nb_pair ; ++l_index)
+      {
+        bool l_single_point = false;
+        geometry::point<T> l_point(0,0);
+        l_nb_intersection += l_polygon.get_segment(l_pairs[2 * l_index]).intersec(l_polygon.get_segment(l_pairs[2 * l_index + 1]),l_single_point,l_point);
+      }
+    double l_intersec_ns = get_ns(l_start,t_clock::now());
+    g_sink += l_nb_intersection;
+    record(std::string("segment_intersec"),m_type,p_shape,l_nb_vertex)
+      .add("nb_pair",l_nb_pair)
+      .add("intersection_ratio",((double)l_nb_intersection) / l_nb_pair)
+      .add("pair_mean_ns",l_intersec_ns / l_nb_pair);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void runner<T>::run_convex(const std::vector<geometry::point<T>> & p_points)
+  {
+    uint32_t l_nb_vertex = p_points.size();
+    t_clock::time_point l_start = t_clock::now();
+    geometry::convex_shape<T> l_shape(p_points);
+    double l_prepare_ns = get_ns(l_start,t_clock::now());
+    std::vector<geometry::point<T>> l_queries = get_queries(l_shape,100000);
+    std::vector<double> l_latencies;
+    l_latencies.reserve(l_queries.size());
+    uint64_t l_nb_inside = 0;
+    for(auto & l_iter : l_queries)
+      {
+        t_clock::time_point l_query_start = t_clock::now();
+        bool l_inside = l_shape.contains(l_iter);
+        l_latencies.push_back(get_ns(l_query_start,t_clock::now()));
+        l_nb_inside += l_inside;
+      }
+    g_sink += l_nb_inside;
+    record l_record(std::string("convex_shape_contains"),m_type,std::string("convex"),l_nb_vertex);
+    l_record.add("prepare_ns",l_prepare_ns).add("nb_query",l_queries.size()).add("inside_ratio",((double)l_nb_inside) / l_queries.size());
+    add_latency(l_record,l_latencies);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void run_type(const std::string & p_type,uint32_t p_max_nb_vertex)
+  {
+    typedef geometry::polygon_generator<T> t_generator;
+    runner<T> l_runner(p_type);
+    for(uint32_t l_nb_vertex = 10 ; l_nb_vertex <= p_max_nb_vertex ; l_nb_vertex *= 10)
+      {
+        // Coordinates stay below 2^24 to be exact in float
+        std::vector<geometry::point<T>> l_convex = t_generator::convex(l_nb_vertex,1e6);
+        l_runner.run(std::string("convex"),l_convex);
+        l_runner.run_convex(l_convex);
+        l_runner.run(std::string("star"),t_generator::star(l_nb_vertex,1e6));
+        l_runner.run(std::string("comb"),t_generator::comb(l_nb_vertex,16,1e5));
+        l_runner.run(std::string("spiral"),t_generator::spiral(l_nb_vertex,16,1e6));
+        // Decomposition depth of nested shape grows with vertex number and
+        // cut_in_convex_polygon recursion with it : keep it reasonable
+        if(l_nb_vertex <= 10000)
+          {
+            l_runner.run(std::string("nested"),t_generator::nested(l_nb_vertex,16));
+          }
+      }
+  }
+}
+
+//------------------------------------------------------------------------------
+int main(int argc,char ** argv)
+{
+  uint32_t l_max_nb_vertex = argc > 1 ? strtoul(argv[1],NULL,0) : 1000000;
+  geometry_bench::run_type<int32_t>(std::string("int"),l_max_nb_vertex);
+  geometry_bench::run_type<float>(std::string("float"),l_max_nb_vertex);
+  geometry_bench::run_type<double>(std::string("double"),l_max_nb_vertex);
+  return geometry_bench::g_sink == 0xFFFFFFFFFFFFFFFFULL;
+}
+//EOF
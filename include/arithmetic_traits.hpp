@@ -0,0 +1,76 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _ARITHMETIC_TRAITS_HPP_
+#define _ARITHMETIC_TRAITS_HPP_
+
+#include <cinttypes>
+
+namespace geometry
+{
+  // Accumulator type used for products of coordinates. Integer coordinates
+  // are widened so that orientation tests and segment crossing points are
+  // exact as long as coordinate differences fit in T, i.e.
+  // |coordinates| < 2^30 for int32_t and |coordinates| < 2^62 for int64_t.
+  // Floating types are kept as is
+  template <typename T>
+  class arithmetic_traits
+  {
+  public:
+    typedef T t_wide;
+  };
+
+  template <>
+  class arithmetic_traits<int16_t>
+  {
+  public:
+    typedef int32_t t_wide;
+  };
+
+  template <>
+  class arithmetic_traits<int32_t>
+  {
+  public:
+    typedef int64_t t_wide;
+  };
+
+#ifdef __SIZEOF_INT128__
+  template <>
+  class arithmetic_traits<int64_t>
+  {
+  public:
+    typedef __int128 t_wide;
+  };
+#endif // __SIZEOF_INT128__
+
+  // Vectorial product of (p_x1,p_y1) and (p_x2,p_y2) computed in wide type
+  template <typename T>
+  inline typename arithmetic_traits<T>::t_wide cross_product(const T & p_x1,const T & p_y1,const T & p_x2,const T & p_y2)
+  {
+    typedef typename arithmetic_traits<T>::t_wide t_wide;
+    return ((t_wide)p_x1) * p_y2 - ((t_wide)p_y1) * p_x2;
+  }
+
+  // Return -1, 0 or 1 according to sign of value
+  template <typename T>
+  inline int get_sign(const T & p_value)
+  {
+    return (p_value > 0) - (p_value < 0);
+  }
+}
+#endif // _ARITHMETIC_TRAITS_HPP_
+//EOF
@@ -0,0 +1,524 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _CONVEX_KERNEL_HPP_
+#define _CONVEX_KERNEL_HPP_
+
+#include "point.hpp"
+#include "segment.hpp"
+#include "arithmetic_traits.hpp"
+#include "geometry_stats.hpp"
+#include <cinttypes>
+
+// Vectorized half plane tests are used when instruction set is available at
+// compile time unless GEOMETRY_NO_SIMD is defined
+#if !defined(GEOMETRY_NO_SIMD) && (defined(__SSE2__) || defined(__AVX__))
+#define GEOMETRY_SIMD
+#include <immintrin.h>
+#endif
+
+namespace geometry
+{
+  // Location of a point relatively to a convex shape
+  typedef enum class convex_location {INSIDE=0,OUTSIDE,VERTEX,BORDER} t_convex_location;
+
+  // Prepared edge table of a convex shape stored as SoA arrays :
+  // edge i goes from (m_x[i],m_y[i]) to (m_x[i+1],m_y[i+1]) and its vector is
+  // (m_coef_x[i],m_coef_y[i]). Vertex arrays have one more element than
+  // coefficient arrays to close the shape without modulo
+  template <typename T>
+  class convex_kernel
+  {
+  public:
+    // Edge number above which wedge binary search is faster than linear scan
+    static const uint32_t wedge_threshold = 64;
+
+    // Linear scan of all edges
+    inline static t_convex_location locate(const T * p_x,
+                                           const T * p_y,
+                                           const T * p_coef_x,
+                                           const T * p_coef_y,
+                                           uint32_t p_nb_edge,
+                                           const point<T> & p,
+                                           uint32_t & p_edge_index);
+
+    // Binary search of the wedge containing point in the fan of triangles
+    // issued from vertex 0 followed by a single orientation test. Relies on
+    // vertices being stored in hull order
+    inline static t_convex_location wedge_locate(const T * p_x,
+                                                 const T * p_y,
+                                                 const T * p_coef_x,
+                                                 const T * p_coef_y,
+                                                 uint32_t p_nb_edge,
+                                                 const point<T> & p,
+                                                 uint32_t & p_edge_index);
+  private:
+    inline static t_convex_location scalar_locate(const T * p_x,
+                                                  const T * p_y,
+                                                  const T * p_coef_x,
+                                                  const T * p_coef_y,
+                                                  uint32_t p_nb_edge,
+                                                  const point<T> & p,
+                                                  uint32_t & p_edge_index);
+  };
+
+  // Check that all vectorial products between edges and vectors going from
+  // edge origin to point are strictly signed. Return false if it is not the
+  // case, in this case point is on a line supporting an edge and the exact
+  // scalar path has to be used. p_uniform is set to true if all products
+  // have the same sign
+  template <typename T>
+  class half_plane_test
+  {
+  public:
+    inline static bool strict(const T * p_x,
+                              const T * p_y,
+                              const T * p_coef_x,
+                              const T * p_coef_y,
+                              uint32_t p_nb_edge,
+                              const T & p_point_x,
+                              const T & p_point_y,
+                              bool & p_uniform);
+    inline static bool strict(const T * p_x,
+                              const T * p_y,
+                              const T * p_coef_x,
+                              const T * p_coef_y,
+                              uint32_t p_begin,
+                              uint32_t p_end,
+                              const T & p_point_x,
+                              const T & p_point_y,
+                              bool & p_positive,
+                              bool & p_negative);
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool half_plane_test<T>::strict(const T * p_x,
+                                  const T * p_y,
+                                  const T * p_coef_x,
+                                  const T * p_coef_y,
+                                  uint32_t p_nb_edge,
+                                  const T & p_point_x,
+                                  const T & p_point_y,
+                                  bool & p_uniform)
+  {
+    bool l_positive = false;
+    bool l_negative = false;
+    if(!strict(p_x,p_y,p_coef_x,p_coef_y,0,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool half_plane_test<T>::strict(const T * p_x,
+                                  const T * p_y,
+                                  const T * p_coef_x,
+                                  const T * p_coef_y,
+                                  uint32_t p_begin,
+                                  uint32_t p_end,
+                                  const T & p_point_x,
+                                  const T & p_point_y,
+                                  bool & p_positive,
+                                  bool & p_negative)
+  {
+    for(uint32_t l_index = p_begin ; l_index < p_end ; ++l_index)
+      {
+        typename arithmetic_traits<T>::t_wide l_vectorial_product = cross_product(p_coef_x[l_index],p_coef_y[l_index],p_point_x - p_x[l_index],p_point_y - p_y[l_index]);
+        bool l_positive = l_vectorial_product > 0;
+        bool l_negative = l_vectorial_product < 0;
+        if(!l_positive && !l_negative)
+          {
+            return false;
+          }
+        p_positive |= l_positive;
+        p_negative |= l_negative;
+      }
+    return true;
+  }
+
+#ifdef GEOMETRY_SIMD
+#ifdef __AVX__
+  //----------------------------------------------------------------------------
+  template <>
+  inline bool half_plane_test<double>::strict(const double * p_x,
+                                              const double * p_y,
+                                              const double * p_coef_x,
+                                              const double * p_coef_y,
+                                              uint32_t p_nb_edge,
+                                              const double & p_point_x,
+                                              const double & p_point_y,
+                                              bool & p_uniform)
+  {
+    const __m256d l_point_x = _mm256_set1_pd(p_point_x);
+    const __m256d l_point_y = _mm256_set1_pd(p_point_y);
+    const __m256d l_zero = _mm256_setzero_pd();
+    int l_positive_mask = 0;
+    int l_negative_mask = 0;
+    uint32_t l_index = 0;
+    for(; l_index + 4 <= p_nb_edge ; l_index += 4)
+      {
+        __m256d l_vectorial_product = _mm256_sub_pd(_mm256_mul_pd(_mm256_loadu_pd(p_coef_x + l_index),_mm256_sub_pd(l_point_y,_mm256_loadu_pd(p_y + l_index))),
+                                                    _mm256_mul_pd(_mm256_loadu_pd(p_coef_y + l_index),_mm256_sub_pd(l_point_x,_mm256_loadu_pd(p_x + l_index))));
+        int l_positive = _mm256_movemask_pd(_mm256_cmp_pd(l_vectorial_product,l_zero,_CMP_GT_OQ));
+        int l_negative = _mm256_movemask_pd(_mm256_cmp_pd(l_vectorial_product,l_zero,_CMP_LT_OQ));
+        if((l_positive | l_negative) != 0xF)
+          {
+            return false;
+          }
+        l_positive_mask |= l_positive;
+        l_negative_mask |= l_negative;
+      }
+    bool l_positive = l_positive_mask;
+    bool l_negative = l_negative_mask;
+    if(!half_plane_test<double>::strict(p_x,p_y,p_coef_x,p_coef_y,l_index,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <>
+  inline bool half_plane_test<float>::strict(const float * p_x,
+                                             const float * p_y,
+                                             const float * p_coef_x,
+                                             const float * p_coef_y,
+                                             uint32_t p_nb_edge,
+                                             const float & p_point_x,
+                                             const float & p_point_y,
+                                             bool & p_uniform)
+  {
+    const __m256 l_point_x = _mm256_set1_ps(p_point_x);
+    const __m256 l_point_y = _mm256_set1_ps(p_point_y);
+    const __m256 l_zero = _mm256_setzero_ps();
+    int l_positive_mask = 0;
+    int l_negative_mask = 0;
+    uint32_t l_index = 0;
+    for(; l_index + 8 <= p_nb_edge ; l_index += 8)
+      {
+        __m256 l_vectorial_product = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(p_coef_x + l_index),_mm256_sub_ps(l_point_y,_mm256_loadu_ps(p_y + l_index))),
+                                                   _mm256_mul_ps(_mm256_loadu_ps(p_coef_y + l_index),_mm256_sub_ps(l_point_x,_mm256_loadu_ps(p_x + l_index))));
+        int l_positive = _mm256_movemask_ps(_mm256_cmp_ps(l_vectorial_product,l_zero,_CMP_GT_OQ));
+        int l_negative = _mm256_movemask_ps(_mm256_cmp_ps(l_vectorial_product,l_zero,_CMP_LT_OQ));
+        if((l_positive | l_negative) != 0xFF)
+          {
+            return false;
+          }
+        l_positive_mask |= l_positive;
+        l_negative_mask |= l_negative;
+      }
+    bool l_positive = l_positive_mask;
+    bool l_negative = l_negative_mask;
+    if(!half_plane_test<float>::strict(p_x,p_y,p_coef_x,p_coef_y,l_index,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+#else // __AVX__
+  //----------------------------------------------------------------------------
+  template <>
+  inline bool half_plane_test<double>::strict(const double * p_x,
+                                              const double * p_y,
+                                              const double * p_coef_x,
+                                              const double * p_coef_y,
+                                              uint32_t p_nb_edge,
+                                              const double & p_point_x,
+                                              const double & p_point_y,
+                                              bool & p_uniform)
+  {
+    const __m128d l_point_x = _mm_set1_pd(p_point_x);
+    const __m128d l_point_y = _mm_set1_pd(p_point_y);
+    const __m128d l_zero = _mm_setzero_pd();
+    int l_positive_mask = 0;
+    int l_negative_mask = 0;
+    uint32_t l_index = 0;
+    for(; l_index + 2 <= p_nb_edge ; l_index += 2)
+      {
+        __m128d l_vectorial_product = _mm_sub_pd(_mm_mul_pd(_mm_loadu_pd(p_coef_x + l_index),_mm_sub_pd(l_point_y,_mm_loadu_pd(p_y + l_index))),
+                                                 _mm_mul_pd(_mm_loadu_pd(p_coef_y + l_index),_mm_sub_pd(l_point_x,_mm_loadu_pd(p_x + l_index))));
+        int l_positive = _mm_movemask_pd(_mm_cmpgt_pd(l_vectorial_product,l_zero));
+        int l_negative = _mm_movemask_pd(_mm_cmplt_pd(l_vectorial_product,l_zero));
+        if((l_positive | l_negative) != 0x3)
+          {
+            return false;
+          }
+        l_positive_mask |= l_positive;
+        l_negative_mask |= l_negative;
+      }
+    bool l_positive = l_positive_mask;
+    bool l_negative = l_negative_mask;
+    if(!half_plane_test<double>::strict(p_x,p_y,p_coef_x,p_coef_y,l_index,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <>
+  inline bool half_plane_test<float>::strict(const float * p_x,
+                                             const float * p_y,
+                                             const float * p_coef_x,
+                                             const float * p_coef_y,
+                                             uint32_t p_nb_edge,
+                                             const float & p_point_x,
+                                             const float & p_point_y,
+                                             bool & p_uniform)
+  {
+    const __m128 l_point_x = _mm_set1_ps(p_point_x);
+    const __m128 l_point_y = _mm_set1_ps(p_point_y);
+    const __m128 l_zero = _mm_setzero_ps();
+    int l_positive_mask = 0;
+    int l_negative_mask = 0;
+    uint32_t l_index = 0;
+    for(; l_index + 4 <= p_nb_edge ; l_index += 4)
+      {
+        __m128 l_vectorial_product = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(p_coef_x + l_index),_mm_sub_ps(l_point_y,_mm_loadu_ps(p_y + l_index))),
+                                                _mm_mul_ps(_mm_loadu_ps(p_coef_y + l_index),_mm_sub_ps(l_point_x,_mm_loadu_ps(p_x + l_index))));
+        int l_positive = _mm_movemask_ps(_mm_cmpgt_ps(l_vectorial_product,l_zero));
+        int l_negative = _mm_movemask_ps(_mm_cmplt_ps(l_vectorial_product,l_zero));
+        if((l_positive | l_negative) != 0xF)
+          {
+            return false;
+          }
+        l_positive_mask |= l_positive;
+        l_negative_mask |= l_negative;
+      }
+    bool l_positive = l_positive_mask;
+    bool l_negative = l_negative_mask;
+    if(!half_plane_test<float>::strict(p_x,p_y,p_coef_x,p_coef_y,l_index,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+#endif // __AVX__
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+  //----------------------------------------------------------------------------
+  template <>
+  inline bool half_plane_test<int32_t>::strict(const int32_t * p_x,
+                                               const int32_t * p_y,
+                                               const int32_t * p_coef_x,
+                                               const int32_t * p_coef_y,
+                                               uint32_t p_nb_edge,
+                                               const int32_t & p_point_x,
+                                               const int32_t & p_point_y,
+                                               bool & p_uniform)
+  {
+    // Products are computed on 64 bits : even and odd lanes are multiplied
+    // separately and sign of each 64 bits product is extracted from its top bit
+#ifdef __AVX2__
+    const __m256i l_point_x = _mm256_set1_epi32(p_point_x);
+    const __m256i l_point_y = _mm256_set1_epi32(p_point_y);
+    const __m256i l_zero = _mm256_setzero_si256();
+    const uint32_t l_width = 8;
+    const int l_full_mask = 0xFF;
+#else
+    const __m128i l_point_x = _mm_set1_epi32(p_point_x);
+    const __m128i l_point_y = _mm_set1_epi32(p_point_y);
+    const __m128i l_zero = _mm_setzero_si128();
+    const uint32_t l_width = 4;
+    const int l_full_mask = 0xF;
+#endif
+    int l_positive_mask = 0;
+    int l_negative_mask = 0;
+    uint32_t l_index = 0;
+    for(; l_index + l_width <= p_nb_edge ; l_index += l_width)
+      {
+#ifdef __AVX2__
+        __m256i l_coef_x = _mm256_loadu_si256((const __m256i*)(p_coef_x + l_index));
+        __m256i l_coef_y = _mm256_loadu_si256((const __m256i*)(p_coef_y + l_index));
+        __m256i l_delta_x = _mm256_sub_epi32(l_point_x,_mm256_loadu_si256((const __m256i*)(p_x + l_index)));
+        __m256i l_delta_y = _mm256_sub_epi32(l_point_y,_mm256_loadu_si256((const __m256i*)(p_y + l_index)));
+        __m256i l_even = _mm256_sub_epi64(_mm256_mul_epi32(l_coef_x,l_delta_y),_mm256_mul_epi32(l_coef_y,l_delta_x));
+        __m256i l_odd = _mm256_sub_epi64(_mm256_mul_epi32(_mm256_srli_epi64(l_coef_x,32),_mm256_srli_epi64(l_delta_y,32)),
+                                         _mm256_mul_epi32(_mm256_srli_epi64(l_coef_y,32),_mm256_srli_epi64(l_delta_x,32)));
+        int l_negative = _mm256_movemask_pd(_mm256_castsi256_pd(l_even)) | (_mm256_movemask_pd(_mm256_castsi256_pd(l_odd)) << 4);
+        int l_null = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(l_even,l_zero))) | (_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(l_odd,l_zero))) << 4);
+#else
+        __m128i l_coef_x = _mm_loadu_si128((const __m128i*)(p_coef_x + l_index));
+        __m128i l_coef_y = _mm_loadu_si128((const __m128i*)(p_coef_y + l_index));
+        __m128i l_delta_x = _mm_sub_epi32(l_point_x,_mm_loadu_si128((const __m128i*)(p_x + l_index)));
+        __m128i l_delta_y = _mm_sub_epi32(l_point_y,_mm_loadu_si128((const __m128i*)(p_y + l_index)));
+        __m128i l_even = _mm_sub_epi64(_mm_mul_epi32(l_coef_x,l_delta_y),_mm_mul_epi32(l_coef_y,l_delta_x));
+        __m128i l_odd = _mm_sub_epi64(_mm_mul_epi32(_mm_srli_epi64(l_coef_x,32),_mm_srli_epi64(l_delta_y,32)),
+                                      _mm_mul_epi32(_mm_srli_epi64(l_coef_y,32),_mm_srli_epi64(l_delta_x,32)));
+        int l_negative = _mm_movemask_pd(_mm_castsi128_pd(l_even)) | (_mm_movemask_pd(_mm_castsi128_pd(l_odd)) << 2);
+        int l_null = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(l_even,l_zero))) | (_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(l_odd,l_zero))) << 2);
+#endif
+        if(l_null)
+          {
+            return false;
+          }
+        l_positive_mask |= ~l_negative & l_full_mask;
+        l_negative_mask |= l_negative;
+      }
+    bool l_positive = l_positive_mask;
+    bool l_negative = l_negative_mask;
+    if(!half_plane_test<int32_t>::strict(p_x,p_y,p_coef_x,p_coef_y,l_index,p_nb_edge,p_point_x,p_point_y,l_positive,l_negative))
+      {
+        return false;
+      }
+    p_uniform = !(l_positive && l_negative);
+    return true;
+  }
+#endif // __AVX2__ || __SSE4_1__
+#endif // GEOMETRY_SIMD
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  t_convex_location convex_kernel<T>::locate(const T * p_x,
+                                             const T * p_y,
+                                             const T * p_coef_x,
+                                             const T * p_coef_y,
+                                             uint32_t p_nb_edge,
+                                             const point<T> & p,
+                                             uint32_t & p_edge_index)
+  {
+    // When point is strictly on one side of every edge line the result only
+    // depends on sign uniformity. Other cases are solved by the exact scalar
+    // path which reproduces edge by edge border semantic. Edge tests are
+    // counted by the path providing the answer
+    bool l_uniform = false;
+    if(half_plane_test<T>::strict(p_x,p_y,p_coef_x,p_coef_y,p_nb_edge,p.get_x(),p.get_y(),l_uniform))
+      {
+        GEOMETRY_STATS_ADD(EDGE_TEST,p_nb_edge);
+        return l_uniform ? t_convex_location::INSIDE : t_convex_location::OUTSIDE;
+      }
+    return scalar_locate(p_x,p_y,p_coef_x,p_coef_y,p_nb_edge,p,p_edge_index);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  t_convex_location convex_kernel<T>::wedge_locate(const T * p_x,
+                                                   const T * p_y,
+                                                   const T * p_coef_x,
+                                                   const T * p_coef_y,
+                                                   uint32_t p_nb_edge,
+                                                   const point<T> & p,
+                                                   uint32_t & p_edge_index)
+  {
+    // Shape orientation
+    typedef typename arithmetic_traits<T>::t_wide t_wide;
+    t_wide l_orient = cross_product(p_x[1] - p_x[0],p_y[1] - p_y[0],p_x[p_nb_edge - 1] - p_x[0],p_y[p_nb_edge - 1] - p_y[0]);
+    if(!l_orient)
+      {
+        return scalar_locate(p_x,p_y,p_coef_x,p_coef_y,p_nb_edge,p,p_edge_index);
+      }
+    bool l_positive = l_orient > 0;
+    T l_point_x = p.get_x() - p_x[0];
+    T l_point_y = p.get_y() - p_y[0];
+
+    // Point is on interior side of ray from vertex 0 to vertex 1 and on
+    // exterior side of ray from vertex 0 to last vertex
+    t_wide l_first_side = cross_product(p_x[1] - p_x[0],p_y[1] - p_y[0],l_point_x,l_point_y);
+    t_wide l_last_side = cross_product(p_x[p_nb_edge - 1] - p_x[0],p_y[p_nb_edge - 1] - p_y[0],l_point_x,l_point_y);
+    if(!l_first_side || !l_last_side)
+      {
+        // Point is on a line supporting first or last edge
+        return scalar_locate(p_x,p_y,p_coef_x,p_coef_y,p_nb_edge,p,p_edge_index);
+      }
+    // Edge tests are only counted when wedge search provides the answer,
+    // scalar fallback counting its own tests
+    if((l_first_side > 0) != l_positive || (l_last_side < 0) != l_positive)
+      {
+        GEOMETRY_STATS_ADD(EDGE_TEST,2);
+        return t_convex_location::OUTSIDE;
+      }
+
+    // Search the last ray having point on its interior side
+    uint32_t l_nb_test = 3;
+    uint32_t l_low = 1;
+    uint32_t l_high = p_nb_edge - 1;
+    while(l_high - l_low > 1)
+      {
+        ++l_nb_test;
+        uint32_t l_middle = l_low + (l_high - l_low) / 2;
+        t_wide l_side = cross_product(p_x[l_middle] - p_x[0],p_y[l_middle] - p_y[0],l_point_x,l_point_y);
+        if(!l_side || (l_side > 0) == l_positive)
+          {
+            l_low = l_middle;
+          }
+        else
+          {
+            l_high = l_middle;
+          }
+      }
+
+    // Point is in wedge between rays to l_low and l_low + 1 so its location
+    // only depends on edge l_low
+    t_wide l_vectorial_product = cross_product(p_coef_x[l_low],p_coef_y[l_low],p.get_x() - p_x[l_low],p.get_y() - p_y[l_low]);
+    if(!l_vectorial_product)
+      {
+        return scalar_locate(p_x,p_y,p_coef_x,p_coef_y,p_nb_edge,p,p_edge_index);
+      }
+    GEOMETRY_STATS_ADD(EDGE_TEST,l_nb_test);
+    (void)l_nb_test;
+    return (l_vectorial_product > 0) == l_positive ? t_convex_location::INSIDE : t_convex_location::OUTSIDE;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  t_convex_location convex_kernel<T>::scalar_locate(const T * p_x,
+                                                    const T * p_y,
+                                                    const T * p_coef_x,
+                                                    const T * p_coef_y,
+                                                    uint32_t p_nb_edge,
+                                                    const point<T> & p,
+                                                    uint32_t & p_edge_index)
+  {
+    typename segment<T>::t_wide l_orient = 0;
+    for(uint32_t l_index = 0 ; l_index < p_nb_edge ; ++l_index)
+      {
+        GEOMETRY_STATS_ADD(EDGE_TEST,1);
+        if((p.get_x() == p_x[l_index] && p.get_y() == p_y[l_index]) || (p.get_x() == p_x[l_index + 1] && p.get_y() == p_y[l_index + 1]))
+          {
+            return t_convex_location::VERTEX;
+          }
+        typename segment<T>::t_wide l_vectorial_product = cross_product(p_coef_x[l_index],p_coef_y[l_index],p.get_x() - p_x[l_index],p.get_y() - p_y[l_index]);
+        if(!l_vectorial_product)
+          {
+            const T & l_min_x = p_x[l_index] <= p_x[l_index + 1] ? p_x[l_index] : p_x[l_index + 1];
+            const T & l_max_x = p_x[l_index] >= p_x[l_index + 1] ? p_x[l_index] : p_x[l_index + 1];
+            const T & l_min_y = p_y[l_index] <= p_y[l_index + 1] ? p_y[l_index] : p_y[l_index + 1];
+            const T & l_max_y = p_y[l_index] >= p_y[l_index + 1] ? p_y[l_index] : p_y[l_index + 1];
+            if((l_min_x < p.get_x() && p.get_x() < l_max_x) || (l_min_y < p.get_y() && p.get_y() < l_max_y))
+              {
+                p_edge_index = l_index;
+                return t_convex_location::BORDER;
+              }
+          }
+        if(!segment<T>::check_convex_continuation(l_vectorial_product,l_orient,l_index == 0))
+          {
+            return t_convex_location::OUTSIDE;
+          }
+      }
+    return t_convex_location::INSIDE;
+  }
+}
+#endif // _CONVEX_KERNEL_HPP_
+//EOF
@@ -0,0 +1,803 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _CONVEX_OPERATIONS_HPP_
+#define _CONVEX_OPERATIONS_HPP_
+
+#include "point.hpp"
+#include "segment.hpp"
+#include "convex_shape.hpp"
+#include "arithmetic_traits.hpp"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Linear time operations between convex shapes of any orientation.
+  // Intersection walks both boundaries together as in O'Rourke algorithm,
+  // crossing points being computed by segment<T>::intersec so that they are
+  // truncated for integers. Contacts at vertices and along edges are
+  // resolved by moving second shape by an infinitesimal translation.
+  // Results are in counterclockwise order and only output vector is
+  // allocated. Areas and centroids are accumulated during the walk without
+  // building the intersection
+  template <typename T=double>
+  class convex_operations
+  {
+  public:
+    // Return false if intersection has no area, p_result being cleared
+    inline static bool intersection(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,std::vector<point<T>> & p_result);
+    // New shape owned by caller, nullptr if intersection has no area
+    inline static convex_shape<T> * intersection(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2);
+    inline static double intersection_area(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2);
+    // Return area, centroid being left unchanged if area is null
+    inline static double intersection_area(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,double & p_centroid_x,double & p_centroid_y);
+
+    // Convex hull of both shapes
+    inline static void union_hull(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,std::vector<point<T>> & p_result);
+    inline static convex_shape<T> union_hull(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2);
+
+    inline static double get_area(const convex_shape<T> & p_shape);
+    inline static double get_area(const convex_shape<T> & p_shape,double & p_centroid_x,double & p_centroid_y);
+
+    // Shapes share at least a point, an interior point if p_consider_line
+    // is false
+    inline static bool overlap(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,bool p_consider_line=true);
+    // Also give translation of second shape along unit axis (p_axis_x,
+    // p_axis_y) making shapes only touch. When shapes overlap p_depth is
+    // penetration depth, otherwise it is the opposite of the widest gap
+    // between shape projections on an edge normal
+    inline static bool overlap(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,double & p_axis_x,double & p_axis_y,double & p_depth,bool p_consider_line=true);
+    // Overlap of p_shape with each candidate, which are first checked
+    // against its bounding box
+    inline static void overlap(const convex_shape<T> & p_shape,const convex_shape<T> * const * p_candidates,uint32_t p_nb_candidate,std::vector<bool> & p_result,bool p_consider_line=true);
+  private:
+    typedef typename arithmetic_traits<T>::t_wide t_wide;
+
+    typedef struct
+    {
+      double m_x;
+      double m_y;
+      double m_depth;
+    } t_axis;
+
+    // Vertices of a shape in counterclockwise order
+    class ccw_view
+    {
+    public:
+      inline ccw_view(const convex_shape<T> & p_shape);
+      inline const point<T> & operator[](uint32_t p_index)const;
+      inline uint32_t size(void)const;
+      inline const convex_shape<T> & get_shape(void)const;
+    private:
+      const convex_shape<T> & m_shape;
+      bool m_reversed;
+    };
+
+    // Output vector, closing removes repeated and aligned points
+    class point_sink
+    {
+    public:
+      inline point_sink(std::vector<point<T>> & p_points);
+      inline void reset(void);
+      inline void add(const point<T> & p);
+      inline bool close(void);
+    private:
+      std::vector<point<T>> & m_points;
+    };
+
+    // Area and centroid moments of emitted polygon, computed relatively to
+    // its first point
+    class moment_sink
+    {
+    public:
+      inline moment_sink(void);
+      inline void reset(void);
+      inline void add(const point<T> & p);
+      inline bool close(void);
+      inline double get_area(void)const;
+      inline void get_centroid(double & p_x,double & p_y)const;
+    private:
+      bool m_started;
+      double m_origin_x;
+      double m_origin_y;
+      double m_first_x;
+      double m_first_y;
+      double m_last_x;
+      double m_last_y;
+      double m_double_area;
+      double m_moment_x;
+      double m_moment_y;
+    };
+
+    typedef enum class inside_flag {UNKNOWN=0,FIRST,SECOND} t_inside_flag;
+
+    inline static int get_turn(const point<T> & p1,const point<T> & p2,const point<T> & p3);
+    // Sides used by intersection walk, second shape being moved by (e,e^2)
+    // with e infinitesimal so that no vertex lies on the line of an edge of
+    // the other shape (simulation of simplicity). Result is never 0
+    inline static int get_side_of_first(const point<T> & p_source1,const point<T> & p_dest1,const point<T> & p2);
+    inline static int get_side_of_second(const point<T> & p_source2,const point<T> & p_dest2,const point<T> & p1);
+    // Limit of crossing point of edges crossing once second shape is moved :
+    // extremity lying on the other edge line if any, crossing point
+    // otherwise
+    inline static point<T> get_crossing(const point<T> & p_source1,const point<T> & p_dest1,const point<T> & p_source2,const point<T> & p_dest2);
+    // First shape is inside second one or on its border
+    inline static bool is_inside(const ccw_view & p_shape1,const ccw_view & p_shape2);
+    template <typename SINK>
+    inline static bool clip(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,SINK & p_sink);
+    // Monotone chain pass adding points of one hull chain of both shapes in
+    // lexicographic order, p_lower selecting chain
+    inline static void add_chain(const ccw_view & p_shape1,const ccw_view & p_shape2,bool p_lower,std::vector<point<T>> & p_result);
+
+    inline static bool are_boxes_separated(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,bool p_consider_line);
+    // Vertex maximizing p_sign * p_side(vertex), searched from p_index
+    // while value does not decrease or in whole shape if p_all is set
+    template <typename SIDE>
+    inline static uint32_t get_extreme(const ccw_view & p_shape,uint32_t p_index,SIDE p_side,int p_sign,bool p_all);
+    // Return false if an edge normal of first shape separates shapes.
+    // Minimum overlap along those normals is kept in p_axis if any, axis
+    // being reversed if p_swapped is set
+    inline static bool check_axes(const ccw_view & p_shape1,const ccw_view & p_shape2,bool p_consider_line,bool p_swapped,t_axis * p_axis);
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_operations<T>::ccw_view::ccw_view(const convex_shape<T> & p_shape):
+    m_shape(p_shape),
+    m_reversed(false)
+  {
+    // Shape may have aligned points but turn at minimum point is strict
+    uint32_t l_nb_point = p_shape.get_nb_point();
+    uint32_t l_min = 0;
+    for(uint32_t l_index = 1 ; l_index < l_nb_point ; ++l_index)
+      {
+        if(p_shape.get_point(l_index) < p_shape.get_point(l_min))
+          {
+            l_min = l_index;
+          }
+      }
+    m_reversed = get_turn(p_shape.get_point((l_min + l_nb_point - 1) % l_nb_point),p_shape.get_point(l_min),p_shape.get_point((l_min + 1) % l_nb_point)) < 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const point<T> & convex_operations<T>::ccw_view::operator[](uint32_t p_index)const
+  {
+    return m_shape.get_point(m_reversed ? m_shape.get_nb_point() - 1 - p_index : p_index);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t convex_operations<T>::ccw_view::size(void)const
+  {
+    return m_shape.get_nb_point();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const convex_shape<T> & convex_operations<T>::ccw_view::get_shape(void)const
+  {
+    return m_shape;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_operations<T>::point_sink::point_sink(std::vector<point<T>> & p_points):
+    m_points(p_points)
+  {
+    m_points.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::point_sink::reset(void)
+  {
+    m_points.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::point_sink::add(const point<T> & p)
+  {
+    if(m_points.empty() || !(p == m_points.back()))
+      {
+        m_points.push_back(p);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::point_sink::close(void)
+  {
+    // Keep only strict left turns, which removes repeated and aligned points
+    // as well as small concavities caused by integer truncation of crossings
+    uint32_t l_size = 0;
+    for(auto & l_iter : m_points)
+      {
+        while(l_size >= 2 && get_turn(m_points[l_size - 2],m_points[l_size - 1],l_iter) <= 0)
+          {
+            --l_size;
+          }
+        m_points[l_size++] = l_iter;
+      }
+    uint32_t l_first = 0;
+    bool l_removed = true;
+    while(l_removed && l_size - l_first >= 3)
+      {
+        l_removed = false;
+        if(get_turn(m_points[l_size - 2],m_points[l_size - 1],m_points[l_first]) <= 0)
+          {
+            --l_size;
+            l_removed = true;
+          }
+        else if(get_turn(m_points[l_size - 1],m_points[l_first],m_points[l_first + 1]) <= 0)
+          {
+            ++l_first;
+            l_removed = true;
+          }
+      }
+    if(l_size - l_first < 3)
+      {
+        m_points.clear();
+        return false;
+      }
+    m_points.erase(m_points.begin() + l_size,m_points.end());
+    m_points.erase(m_points.begin(),m_points.begin() + l_first);
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_operations<T>::moment_sink::moment_sink(void)
+  {
+    reset();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::moment_sink::reset(void)
+  {
+    m_started = false;
+    m_origin_x = m_origin_y = 0;
+    m_first_x = m_first_y = 0;
+    m_last_x = m_last_y = 0;
+    m_double_area = 0;
+    m_moment_x = m_moment_y = 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::moment_sink::add(const point<T> & p)
+  {
+    if(!m_started)
+      {
+        m_started = true;
+        m_origin_x = p.get_x();
+        m_origin_y = p.get_y();
+        return;
+      }
+    double l_x = (double)p.get_x() - m_origin_x;
+    double l_y = (double)p.get_y() - m_origin_y;
+    double l_cross = m_last_x * l_y - l_x * m_last_y;
+    m_double_area += l_cross;
+    m_moment_x += (m_last_x + l_x) * l_cross;
+    m_moment_y += (m_last_y + l_y) * l_cross;
+    m_last_x = l_x;
+    m_last_y = l_y;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::moment_sink::close(void)
+  {
+    // Closing edge ends at origin so its cross product is null
+    return m_double_area > 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double convex_operations<T>::moment_sink::get_area(void)const
+  {
+    return m_double_area / 2;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::moment_sink::get_centroid(double & p_x,double & p_y)const
+  {
+    p_x = m_origin_x + m_moment_x / (3 * m_double_area);
+    p_y = m_origin_y + m_moment_y / (3 * m_double_area);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int convex_operations<T>::get_turn(const point<T> & p1,const point<T> & p2,const point<T> & p3)
+  {
+    return get_sign(cross_product(p2.get_x() - p1.get_x(),p2.get_y() - p1.get_y(),p3.get_x() - p1.get_x(),p3.get_y() - p1.get_y()));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int convex_operations<T>::get_side_of_first(const point<T> & p_source1,const point<T> & p_dest1,const point<T> & p2)
+  {
+    int l_turn = get_turn(p_source1,p_dest1,p2);
+    if(l_turn)
+      {
+        return l_turn;
+      }
+    // Sign of cross product of edge with translation
+    if(p_dest1.get_y() != p_source1.get_y())
+      {
+        return p_source1.get_y() < p_dest1.get_y() ? -1 : 1;
+      }
+    return p_source1.get_x() < p_dest1.get_x() ? 1 : -1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int convex_operations<T>::get_side_of_second(const point<T> & p_source2,const point<T> & p_dest2,const point<T> & p1)
+  {
+    int l_turn = get_turn(p_source2,p_dest2,p1);
+    if(l_turn)
+      {
+        return l_turn;
+      }
+    // Opposite of sign of cross product of edge with translation
+    if(p_dest2.get_y() != p_source2.get_y())
+      {
+        return p_source2.get_y() < p_dest2.get_y() ? 1 : -1;
+      }
+    return p_source2.get_x() < p_dest2.get_x() ? -1 : 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  point<T> convex_operations<T>::get_crossing(const point<T> & p_source1,const point<T> & p_dest1,const point<T> & p_source2,const point<T> & p_dest2)
+  {
+    // Edges are not parallel so an extremity on the other edge line is the
+    // crossing point, which is then exact
+    if(!get_turn(p_source1,p_dest1,p_source2))
+      {
+        return p_source2;
+      }
+    if(!get_turn(p_source1,p_dest1,p_dest2))
+      {
+        return p_dest2;
+      }
+    if(!get_turn(p_source2,p_dest2,p_source1))
+      {
+        return p_source1;
+      }
+    if(!get_turn(p_source2,p_dest2,p_dest1))
+      {
+        return p_dest1;
+      }
+    point<T> l_point(p_dest1);
+    bool l_single_point = false;
+    bool l_crossing = segment<T>(p_source1,p_dest1).intersec(segment<T>(p_source2,p_dest2),l_single_point,l_point);
+    assert(l_crossing && l_single_point);
+    (void)l_crossing;
+    return l_point;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::is_inside(const ccw_view & p_shape1,const ccw_view & p_shape2)
+  {
+    // Without crossing, first vertex not on border tells if shape is inside
+    for(uint32_t l_index = 0 ; l_index < p_shape1.size() ; ++l_index)
+      {
+        t_convex_location l_location = p_shape2.get_shape().locate(p_shape1[l_index]);
+        if(t_convex_location::INSIDE == l_location)
+          {
+            return true;
+          }
+        if(t_convex_location::OUTSIDE == l_location)
+          {
+            return false;
+          }
+      }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  template <typename SINK>
+  bool convex_operations<T>::clip(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,SINK & p_sink)
+  {
+    ccw_view l_shape1(p_shape1);
+    ccw_view l_shape2(p_shape2);
+    uint32_t l_nb1 = l_shape1.size();
+    uint32_t l_nb2 = l_shape2.size();
+    if(p_shape1.get_max_x() < p_shape2.get_min_x() || p_shape2.get_max_x() < p_shape1.get_min_x() ||
+       p_shape1.get_max_y() < p_shape2.get_min_y() || p_shape2.get_max_y() < p_shape1.get_min_y())
+      {
+        return false;
+      }
+
+    // Edges ending at vertices l_index1 and l_index2 advance in turn, the
+    // one pointing toward the other edge line moving first. Vertices are
+    // emitted while the shape they belong to is the inner one
+    uint32_t l_index1 = 0;
+    uint32_t l_index2 = 0;
+    uint32_t l_nb_advance1 = 0;
+    uint32_t l_nb_advance2 = 0;
+    t_inside_flag l_inside = t_inside_flag::UNKNOWN;
+    bool l_first_point = true;
+    do
+      {
+        const point<T> & l_dest1 = l_shape1[l_index1];
+        const point<T> & l_source1 = l_shape1[(l_index1 + l_nb1 - 1) % l_nb1];
+        const point<T> & l_dest2 = l_shape2[l_index2];
+        const point<T> & l_source2 = l_shape2[(l_index2 + l_nb2 - 1) % l_nb2];
+        int l_cross = get_sign(cross_product(l_dest1.get_x() - l_source1.get_x(),l_dest1.get_y() - l_source1.get_y(),l_dest2.get_x() - l_source2.get_x(),l_dest2.get_y() - l_source2.get_y()));
+        // Side of edge extremities relatively to the other edge, l_side1 and
+        // l_side2 being those of edge heads
+        int l_side_source1 = get_side_of_second(l_source2,l_dest2,l_source1);
+        int l_side1 = get_side_of_second(l_source2,l_dest2,l_dest1);
+        int l_side_source2 = get_side_of_first(l_source1,l_dest1,l_source2);
+        int l_side2 = get_side_of_first(l_source1,l_dest1,l_dest2);
+
+        if(l_side_source1 != l_side1 && l_side_source2 != l_side2)
+          {
+            if(t_inside_flag::UNKNOWN == l_inside && l_first_point)
+              {
+                l_nb_advance1 = l_nb_advance2 = 0;
+                l_first_point = false;
+              }
+            p_sink.add(get_crossing(l_source1,l_dest1,l_source2,l_dest2));
+            // Edge heads are on opposite sides of crossing edges
+            l_inside = l_side1 > 0 ? t_inside_flag::FIRST : t_inside_flag::SECOND;
+          }
+
+        // Edges are never aligned once second shape is moved
+        bool l_advance1;
+        if(!l_cross && l_side1 < 0 && l_side2 < 0)
+          {
+            // Parallel edges facing outward : shapes are separated
+            p_sink.reset();
+            return false;
+          }
+        else if(l_cross >= 0)
+          {
+            l_advance1 = l_side2 > 0;
+          }
+        else
+          {
+            l_advance1 = l_side1 <= 0;
+          }
+        if(l_advance1)
+          {
+            if(t_inside_flag::FIRST == l_inside)
+              {
+                p_sink.add(l_dest1);
+              }
+            ++l_nb_advance1;
+            l_index1 = (l_index1 + 1) % l_nb1;
+          }
+        else
+          {
+            if(t_inside_flag::SECOND == l_inside)
+              {
+                p_sink.add(l_dest2);
+              }
+            ++l_nb_advance2;
+            l_index2 = (l_index2 + 1) % l_nb2;
+          }
+      }
+    while((l_nb_advance1 < l_nb1 || l_nb_advance2 < l_nb2) && l_nb_advance1 < 2 * l_nb1 && l_nb_advance2 < 2 * l_nb2);
+
+    if(t_inside_flag::UNKNOWN == l_inside)
+      {
+        // Boundaries do not cross : result is one of the shapes or nothing
+        p_sink.reset();
+        const ccw_view * l_inner = is_inside(l_shape1,l_shape2) ? &l_shape1 : (is_inside(l_shape2,l_shape1) ? &l_shape2 : nullptr);
+        if(!l_inner)
+          {
+            return false;
+          }
+        for(uint32_t l_index = 0 ; l_index < l_inner->size() ; ++l_index)
+          {
+            p_sink.add((*l_inner)[l_index]);
+          }
+      }
+    return p_sink.close();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::intersection(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,std::vector<point<T>> & p_result)
+  {
+    point_sink l_sink(p_result);
+    return clip(p_shape1,p_shape2,l_sink);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_shape<T> * convex_operations<T>::intersection(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2)
+  {
+    std::vector<point<T>> l_points;
+    return intersection(p_shape1,p_shape2,l_points) ? new convex_shape<T>(std::move(l_points)) : nullptr;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double convex_operations<T>::intersection_area(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2)
+  {
+    moment_sink l_sink;
+    return clip(p_shape1,p_shape2,l_sink) ? l_sink.get_area() : 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double convex_operations<T>::intersection_area(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,double & p_centroid_x,double & p_centroid_y)
+  {
+    moment_sink l_sink;
+    if(!clip(p_shape1,p_shape2,l_sink))
+      {
+        return 0;
+      }
+    l_sink.get_centroid(p_centroid_x,p_centroid_y);
+    return l_sink.get_area();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double convex_operations<T>::get_area(const convex_shape<T> & p_shape)
+  {
+    double l_x;
+    double l_y;
+    return get_area(p_shape,l_x,l_y);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double convex_operations<T>::get_area(const convex_shape<T> & p_shape,double & p_centroid_x,double & p_centroid_y)
+  {
+    ccw_view l_shape(p_shape);
+    moment_sink l_sink;
+    for(uint32_t l_index = 0 ; l_index < l_shape.size() ; ++l_index)
+      {
+        l_sink.add(l_shape[l_index]);
+      }
+    if(!l_sink.close())
+      {
+        return 0;
+      }
+    l_sink.get_centroid(p_centroid_x,p_centroid_y);
+    return l_sink.get_area();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::add_chain(const ccw_view & p_shape1,const ccw_view & p_shape2,bool p_lower,std::vector<point<T>> & p_result)
+  {
+    // In counterclockwise order lower chain goes from minimum to maximum
+    // point and upper chain from maximum to minimum point. Chains of both
+    // shapes are merged on the fly
+    const ccw_view * l_shapes[2] = {&p_shape1,&p_shape2};
+    uint32_t l_current[2];
+    uint32_t l_remaining[2];
+    for(uint32_t l_shape_index = 0 ; l_shape_index < 2 ; ++l_shape_index)
+      {
+        const ccw_view & l_shape = *l_shapes[l_shape_index];
+        uint32_t l_min = 0;
+        uint32_t l_max = 0;
+        for(uint32_t l_index = 1 ; l_index < l_shape.size() ; ++l_index)
+          {
+            if(l_shape[l_index] < l_shape[l_min]) l_min = l_index;
+            if(l_shape[l_max] < l_shape[l_index]) l_max = l_index;
+          }
+        l_current[l_shape_index] = p_lower ? l_min : l_max;
+        uint32_t l_last = p_lower ? l_max : l_min;
+        l_remaining[l_shape_index] = (l_last + l_shape.size() - l_current[l_shape_index]) % l_shape.size() + 1;
+      }
+    // Upper hull points can only be popped back to the end of lower hull
+    uint32_t l_bottom = p_result.size();
+    while(l_remaining[0] || l_remaining[1])
+      {
+        uint32_t l_shape_index = !l_remaining[0] ? 1 : (!l_remaining[1] ? 0 : (((*l_shapes[1])[l_current[1]] < (*l_shapes[0])[l_current[0]]) == p_lower ? 1 : 0));
+        const ccw_view & l_shape = *l_shapes[l_shape_index];
+        const point<T> & l_point = l_shape[l_current[l_shape_index]];
+        l_current[l_shape_index] = (l_current[l_shape_index] + 1) % l_shape.size();
+        --l_remaining[l_shape_index];
+        while(p_result.size() >= l_bottom + 2 && get_turn(p_result[p_result.size() - 2],p_result.back(),l_point) <= 0)
+          {
+            p_result.pop_back();
+          }
+        p_result.push_back(l_point);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::union_hull(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,std::vector<point<T>> & p_result)
+  {
+    // Andrew monotone chain : lower hull of both lower chains then upper
+    // hull of both upper chains, chain extremities being shared
+    ccw_view l_shape1(p_shape1);
+    ccw_view l_shape2(p_shape2);
+    p_result.clear();
+    p_result.reserve(l_shape1.size() + l_shape2.size() + 2);
+    add_chain(l_shape1,l_shape2,true,p_result);
+    uint32_t l_lower_size = p_result.size();
+    add_chain(l_shape1,l_shape2,false,p_result);
+    // Upper hull starts by maximum point ending lower hull
+    p_result.erase(p_result.begin() + l_lower_size);
+    p_result.pop_back();
+    assert(p_result.size() >= 3);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_shape<T> convex_operations<T>::union_hull(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2)
+  {
+    std::vector<point<T>> l_points;
+    union_hull(p_shape1,p_shape2,l_points);
+    return convex_shape<T>(std::move(l_points));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::are_boxes_separated(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,bool p_consider_line)
+  {
+    if(p_consider_line)
+      {
+        return p_shape1.get_max_x() < p_shape2.get_min_x() || p_shape2.get_max_x() < p_shape1.get_min_x() ||
+          p_shape1.get_max_y() < p_shape2.get_min_y() || p_shape2.get_max_y() < p_shape1.get_min_y();
+      }
+    return p_shape1.get_max_x() <= p_shape2.get_min_x() || p_shape2.get_max_x() <= p_shape1.get_min_x() ||
+      p_shape1.get_max_y() <= p_shape2.get_min_y() || p_shape2.get_max_y() <= p_shape1.get_min_y();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  template <typename SIDE>
+  uint32_t convex_operations<T>::get_extreme(const ccw_view & p_shape,uint32_t p_index,SIDE p_side,int p_sign,bool p_all)
+  {
+    uint32_t l_nb_point = p_shape.size();
+    uint32_t l_current = p_index;
+    t_wide l_value = p_sign * p_side(p_shape[p_index]);
+    // Number of steps is bounded in case all vertices are aligned
+    for(uint32_t l_step = 1 ; l_step < l_nb_point ; ++l_step)
+      {
+        l_current = (l_current + 1) % l_nb_point;
+        t_wide l_current_value = p_sign * p_side(p_shape[l_current]);
+        if(l_current_value >= l_value)
+          {
+            l_value = l_current_value;
+            p_index = l_current;
+          }
+        else if(!p_all)
+          {
+            break;
+          }
+      }
+    return p_index;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::check_axes(const ccw_view & p_shape1,const ccw_view & p_shape2,bool p_consider_line,bool p_swapped,t_axis * p_axis)
+  {
+    // Sides of second shape vertices relatively to an edge line vary
+    // unimodally around shape. As edges of first shape turn
+    // counterclockwise, vertices of extreme sides move forward so they are
+    // followed in a single turn of each shape
+    uint32_t l_nb1 = p_shape1.size();
+    uint32_t l_max2 = 0;
+    uint32_t l_min2 = 0;
+    uint32_t l_max1 = 0;
+    bool l_started = false;
+    bool l_overlap = true;
+    for(uint32_t l_index = 0 ; l_index < l_nb1 ; ++l_index)
+      {
+        const point<T> & l_source = p_shape1[l_index];
+        const point<T> & l_dest = p_shape1[(l_index + 1) % l_nb1];
+        if(l_source == l_dest)
+          {
+            continue;
+          }
+        T l_dx = l_dest.get_x() - l_source.get_x();
+        T l_dy = l_dest.get_y() - l_source.get_y();
+        auto l_side = [&](const point<T> & p) -> t_wide { return cross_product(l_dx,l_dy,p.get_x() - l_source.get_x(),p.get_y() - l_source.get_y()); };
+        l_max2 = get_extreme(p_shape2,l_max2,l_side,1,!l_started);
+        t_wide l_max_side2 = l_side(p_shape2[l_max2]);
+        if(l_max_side2 < 0 || (!p_consider_line && !l_max_side2))
+          {
+            l_overlap = false;
+            if(!p_axis)
+              {
+                return false;
+              }
+          }
+        if(p_axis)
+          {
+            // Projections on inward normal : first shape covers
+            // [0,l_max_side1], second one [l_min_side2,l_max_side2]
+            l_min2 = get_extreme(p_shape2,l_min2,l_side,-1,!l_started);
+            l_max1 = get_extreme(p_shape1,l_max1,l_side,1,!l_started);
+            double l_length = std::sqrt((double)l_dx * l_dx + (double)l_dy * l_dy);
+            double l_outward = (double)l_max_side2 / l_length;
+            double l_inward = ((double)l_side(p_shape1[l_max1]) - (double)l_side(p_shape2[l_min2])) / l_length;
+            double l_depth = std::min(l_outward,l_inward);
+            if(l_depth < p_axis->m_depth)
+              {
+                double l_sign = (l_outward <= l_inward) == p_swapped ? -1 : 1;
+                p_axis->m_depth = l_depth;
+                p_axis->m_x = l_sign * l_dy / l_length;
+                p_axis->m_y = -l_sign * l_dx / l_length;
+              }
+          }
+        l_started = true;
+      }
+    return l_overlap;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::overlap(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,bool p_consider_line)
+  {
+    if(are_boxes_separated(p_shape1,p_shape2,p_consider_line))
+      {
+        return false;
+      }
+    ccw_view l_shape1(p_shape1);
+    ccw_view l_shape2(p_shape2);
+    return check_axes(l_shape1,l_shape2,p_consider_line,false,nullptr) && check_axes(l_shape2,l_shape1,p_consider_line,true,nullptr);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_operations<T>::overlap(const convex_shape<T> & p_shape1,const convex_shape<T> & p_shape2,double & p_axis_x,double & p_axis_y,double & p_depth,bool p_consider_line)
+  {
+    ccw_view l_shape1(p_shape1);
+    ccw_view l_shape2(p_shape2);
+    t_axis l_axis = {0,0,std::numeric_limits<double>::max()};
+    // Both calls are needed to find minimum overlap
+    bool l_overlap1 = check_axes(l_shape1,l_shape2,p_consider_line,false,&l_axis);
+    bool l_overlap2 = check_axes(l_shape2,l_shape1,p_consider_line,true,&l_axis);
+    p_axis_x = l_axis.m_x;
+    p_axis_y = l_axis.m_y;
+    p_depth = l_axis.m_depth;
+    return l_overlap1 && l_overlap2;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_operations<T>::overlap(const convex_shape<T> & p_shape,const convex_shape<T> * const * p_candidates,uint32_t p_nb_candidate,std::vector<bool> & p_result,bool p_consider_line)
+  {
+    p_result.assign(p_nb_candidate,false);
+    ccw_view l_shape(p_shape);
+    for(uint32_t l_index = 0 ; l_index < p_nb_candidate ; ++l_index)
+      {
+        const convex_shape<T> & l_candidate = *p_candidates[l_index];
+        if(are_boxes_separated(p_shape,l_candidate,p_consider_line))
+          {
+            continue;
+          }
+        ccw_view l_candidate_view(l_candidate);
+        p_result[l_index] = check_axes(l_shape,l_candidate_view,p_consider_line,false,nullptr) && check_axes(l_candidate_view,l_shape,p_consider_line,true,nullptr);
+      }
+  }
+}
+#endif // _CONVEX_OPERATIONS_HPP_
+//EOF
@@ -0,0 +1,810 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _CONVEX_PARTITION_HPP_
+#define _CONVEX_PARTITION_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include "convex_kernel.hpp"
+#include "arithmetic_traits.hpp"
+#include "geometry_stats.hpp"
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Alternative preparation of a simple polygon : polygon is cut in y-monotone
+  // polygons by a plane sweep, each of them is triangulated, then diagonals
+  // are removed as long as the pieces they separate stay convex
+  // (Hertel-Mehlhorn). Whole preparation is O(n log n) and does not depend on
+  // decomposition depth of cut_in_convex_polygon. Pieces have disjoint
+  // interiors and are found through a uniform grid so that contains only
+  // tests the few pieces overlapping the cell of the point.
+  // Polygon does not need to be cut in convex polygons and its orientation
+  // does not matter. Partition is immutable : queries can be shared between
+  // threads
+  template <typename T=double>
+  class convex_partition
+  {
+  public:
+    inline convex_partition(const polygon<T> & p_polygon);
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    inline uint32_t get_nb_piece(void)const;
+    inline uint32_t get_nb_edge(void)const;
+  private:
+    typedef typename arithmetic_traits<T>::t_wide t_wide;
+    typedef std::pair<uint32_t,uint32_t> t_diagonal;
+
+    // Polygon edges and diagonals as half edges : half edge 2i goes from
+    // polygon vertex i to vertex i + 1 and has polygon interior on its left,
+    // half edges above 2 * polygon vertex number are diagonals. Twin of half
+    // edge h is h ^ 1. Half edges issued from a vertex are linked in
+    // counterclockwise order
+    typedef struct
+    {
+      std::vector<uint32_t> m_origin;
+      std::vector<uint32_t> m_around_next;
+      std::vector<uint32_t> m_around_prev;
+      std::vector<uint8_t> m_removed;
+    } t_half_edges;
+
+    typedef struct
+    {
+      T m_min_x;
+      T m_max_x;
+      T m_min_y;
+      T m_max_y;
+      uint32_t m_first_edge;
+      uint32_t m_nb_edge;
+    } t_piece;
+
+    // Order of edges crossing sweep line from left to right. Edge i goes from
+    // vertex i to vertex i + 1, edge of index vertex number is the point
+    // whose left edge is searched
+    class status_less
+    {
+    public:
+      inline status_less(const std::vector<point<T>> & p_points,const point<T> & p_query);
+      inline bool operator()(uint32_t p_edge1,uint32_t p_edge2)const;
+    private:
+      inline void get_ends(uint32_t p_edge,const point<T> * & p_top,const point<T> * & p_bottom)const;
+      inline static int get_side(const point<T> & p,const point<T> & p_top,const point<T> & p_bottom);
+
+      const std::vector<point<T>> * m_points;
+      const point<T> * m_query;
+    };
+
+    // Sweep goes downward : p1 is above p2 if it has a greater y, or the same
+    // y and a smaller x
+    inline static bool is_above(const point<T> & p1,const point<T> & p2);
+    inline static int get_turn(const point<T> & p1,const point<T> & p2,const point<T> & p3);
+    // Check if p is strictly inside segment [p1,p2]
+    inline static bool is_between(const point<T> & p1,const point<T> & p,const point<T> & p2);
+
+    inline static void get_monotone_diagonals(const std::vector<point<T>> & p_points,std::vector<t_diagonal> & p_diagonals);
+    inline static void triangulate_monotone(const std::vector<point<T>> & p_points,const std::vector<uint32_t> & p_vertices,std::vector<t_diagonal> & p_diagonals);
+    // Add diagonals from p_apex to chain vertices of indexes [p_first,p_end).
+    // Diagonal going through a neighbour chain vertex is skipped : the two
+    // triangles it separates form a single convex piece
+    inline static void add_fan(const std::vector<point<T>> & p_points,uint32_t p_apex,const std::vector<uint32_t> & p_chain,uint32_t p_first,uint32_t p_end,std::vector<t_diagonal> & p_diagonals);
+    inline static void link(const std::vector<point<T>> & p_points,const std::vector<t_diagonal> & p_diagonals,t_half_edges & p_half_edges);
+    inline static bool is_convex_corner(const std::vector<point<T>> & p_points,const t_half_edges & p_half_edges,uint32_t p_half_edge);
+    inline static void merge_pieces(const std::vector<point<T>> & p_points,t_half_edges & p_half_edges);
+    // Half edges of inner faces : face i is made of half edges
+    // p_face_edges[p_face_first[i]] to p_face_edges[p_face_first[i + 1] - 1]
+    inline static void get_faces(const t_half_edges & p_half_edges,uint32_t p_nb_point,std::vector<uint32_t> & p_face_edges,std::vector<uint32_t> & p_face_first);
+
+    inline void build_grid(void);
+    inline uint32_t grid_x(const T & p_x)const;
+    inline uint32_t grid_y(const T & p_y)const;
+
+    T m_min_x;
+    T m_max_x;
+    T m_min_y;
+    T m_max_y;
+
+    // Edge table shared by all pieces with an additional closing vertex per
+    // piece as in prepared_polygon
+    std::vector<t_piece> m_pieces;
+    std::vector<T> m_x;
+    std::vector<T> m_y;
+    std::vector<T> m_coef_x;
+    std::vector<T> m_coef_y;
+    std::vector<uint8_t> m_polygon_segments;
+
+    // Grid : piece ids of cell i are m_cell_ids[m_cell_first[i]] to
+    // m_cell_ids[m_cell_first[i + 1] - 1]
+    uint32_t m_grid_width;
+    uint32_t m_grid_height;
+    double m_cell_width;
+    double m_cell_height;
+    std::vector<uint32_t> m_cell_first;
+    std::vector<uint32_t> m_cell_ids;
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_partition<T>::status_less::status_less(const std::vector<point<T>> & p_points,const point<T> & p_query):
+    m_points(&p_points),
+    m_query(&p_query)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::status_less::get_ends(uint32_t p_edge,const point<T> * & p_top,const point<T> * & p_bottom)const
+  {
+    uint32_t l_nb_point = m_points->size();
+    if(p_edge == l_nb_point)
+      {
+        p_top = p_bottom = m_query;
+        return;
+      }
+    const point<T> & l_source = (*m_points)[p_edge];
+    const point<T> & l_dest = (*m_points)[p_edge + 1 < l_nb_point ? p_edge + 1 : 0];
+    bool l_source_above = is_above(l_source,l_dest);
+    p_top = l_source_above ? &l_source : &l_dest;
+    p_bottom = l_source_above ? &l_dest : &l_source;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int convex_partition<T>::status_less::get_side(const point<T> & p,const point<T> & p_top,const point<T> & p_bottom)
+  {
+    // Positive when point is on the left of edge going upward
+    return get_sign(cross_product(p_top.get_x() - p_bottom.get_x(),p_top.get_y() - p_bottom.get_y(),p.get_x() - p_bottom.get_x(),p.get_y() - p_bottom.get_y()));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_partition<T>::status_less::operator()(uint32_t p_edge1,uint32_t p_edge2)const
+  {
+    if(p_edge1 == p_edge2)
+      {
+        return false;
+      }
+    // Edges do not cross so their order is given by the position of the end
+    // of one of them relatively to the other one, taking the top end of the
+    // edge starting last which is inside the y range of both edges
+    const point<T> * l_top1;
+    const point<T> * l_bottom1;
+    const point<T> * l_top2;
+    const point<T> * l_bottom2;
+    get_ends(p_edge1,l_top1,l_bottom1);
+    get_ends(p_edge2,l_top2,l_bottom2);
+    if(!is_above(*l_top1,*l_top2))
+      {
+        int l_side = get_side(*l_top1,*l_top2,*l_bottom2);
+        if(!l_side)
+          {
+            l_side = get_side(*l_bottom1,*l_top2,*l_bottom2);
+          }
+        return l_side ? l_side > 0 : p_edge1 < p_edge2;
+      }
+    int l_side = get_side(*l_top2,*l_top1,*l_bottom1);
+    if(!l_side)
+      {
+        l_side = get_side(*l_bottom2,*l_top1,*l_bottom1);
+      }
+    return l_side ? l_side < 0 : p_edge1 < p_edge2;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_partition<T>::is_above(const point<T> & p1,const point<T> & p2)
+  {
+    return p1.get_y() != p2.get_y() ? p1.get_y() > p2.get_y() : p1.get_x() < p2.get_x();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int convex_partition<T>::get_turn(const point<T> & p1,const point<T> & p2,const point<T> & p3)
+  {
+    return get_sign(cross_product(p2.get_x() - p1.get_x(),p2.get_y() - p1.get_y(),p3.get_x() - p1.get_x(),p3.get_y() - p1.get_y()));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_partition<T>::is_between(const point<T> & p1,const point<T> & p,const point<T> & p2)
+  {
+    if(get_turn(p1,p,p2))
+      {
+        return false;
+      }
+    t_wide l_scalar_product = ((t_wide)(p1.get_x() - p.get_x())) * (p2.get_x() - p.get_x()) + ((t_wide)(p1.get_y() - p.get_y())) * (p2.get_y() - p.get_y());
+    return l_scalar_product < 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_partition<T>::convex_partition(const polygon<T> & p_polygon):
+    m_min_x(p_polygon.get_min_x()),
+    m_max_x(p_polygon.get_max_x()),
+    m_min_y(p_polygon.get_min_y()),
+    m_max_y(p_polygon.get_max_y()),
+    m_grid_width(0),
+    m_grid_height(0),
+    m_cell_width(0),
+    m_cell_height(0)
+  {
+    // Work on counterclockwise vertices. Minimum point is a convex vertex so
+    // its turn gives polygon orientation
+    uint32_t l_nb_point = p_polygon.get_nb_point();
+    std::vector<point<T>> l_points;
+    l_points.reserve(l_nb_point);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        l_points.push_back(p_polygon.get_point(l_index));
+      }
+    uint32_t l_min = std::min_element(l_points.begin(),l_points.end()) - l_points.begin();
+    if(get_turn(l_points[(l_min + l_nb_point - 1) % l_nb_point],l_points[l_min],l_points[(l_min + 1) % l_nb_point]) < 0)
+      {
+        std::reverse(l_points.begin(),l_points.end());
+      }
+
+    // Monotone polygons then triangles
+    std::vector<t_diagonal> l_diagonals;
+    get_monotone_diagonals(l_points,l_diagonals);
+    t_half_edges l_half_edges;
+    link(l_points,l_diagonals,l_half_edges);
+    std::vector<uint32_t> l_face_edges;
+    std::vector<uint32_t> l_face_first;
+    get_faces(l_half_edges,l_nb_point,l_face_edges,l_face_first);
+    std::vector<uint32_t> l_vertices;
+    for(uint32_t l_face = 0 ; l_face + 1 < l_face_first.size() ; ++l_face)
+      {
+        l_vertices.clear();
+        for(uint32_t l_index = l_face_first[l_face] ; l_index < l_face_first[l_face + 1] ; ++l_index)
+          {
+            l_vertices.push_back(l_half_edges.m_origin[l_face_edges[l_index]]);
+          }
+        triangulate_monotone(l_points,l_vertices,l_diagonals);
+      }
+
+    // Convex pieces
+    link(l_points,l_diagonals,l_half_edges);
+    merge_pieces(l_points,l_half_edges);
+    get_faces(l_half_edges,l_nb_point,l_face_edges,l_face_first);
+    m_pieces.reserve(l_face_first.size() - 1);
+    for(uint32_t l_face = 0 ; l_face + 1 < l_face_first.size() ; ++l_face)
+      {
+        t_piece l_piece;
+        l_piece.m_min_x = std::numeric_limits<T>::max();
+        l_piece.m_max_x = std::numeric_limits<T>::lowest();
+        l_piece.m_min_y = std::numeric_limits<T>::max();
+        l_piece.m_max_y = std::numeric_limits<T>::lowest();
+        l_piece.m_first_edge = m_x.size();
+        l_piece.m_nb_edge = l_face_first[l_face + 1] - l_face_first[l_face];
+        for(uint32_t l_index = l_face_first[l_face] ; l_index < l_face_first[l_face + 1] ; ++l_index)
+          {
+            uint32_t l_half_edge = l_face_edges[l_index];
+            const point<T> & l_source = l_points[l_half_edges.m_origin[l_half_edge]];
+            const point<T> & l_dest = l_points[l_half_edges.m_origin[l_half_edge ^ 1]];
+            l_piece.m_min_x = std::min(l_piece.m_min_x,l_source.get_x());
+            l_piece.m_max_x = std::max(l_piece.m_max_x,l_source.get_x());
+            l_piece.m_min_y = std::min(l_piece.m_min_y,l_source.get_y());
+            l_piece.m_max_y = std::max(l_piece.m_max_y,l_source.get_y());
+            m_x.push_back(l_source.get_x());
+            m_y.push_back(l_source.get_y());
+            m_coef_x.push_back(l_dest.get_x() - l_source.get_x());
+            m_coef_y.push_back(l_dest.get_y() - l_source.get_y());
+            m_polygon_segments.push_back(l_half_edge < 2 * l_nb_point);
+          }
+        m_x.push_back(m_x[l_piece.m_first_edge]);
+        m_y.push_back(m_y[l_piece.m_first_edge]);
+        m_coef_x.push_back(0);
+        m_coef_y.push_back(0);
+        m_polygon_segments.push_back(false);
+        m_pieces.push_back(l_piece);
+      }
+    build_grid();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::get_monotone_diagonals(const std::vector<point<T>> & p_points,std::vector<t_diagonal> & p_diagonals)
+  {
+    // Plane sweep from top to bottom. Status contains edges having polygon
+    // interior on their right, helper of an edge being the lowest vertex
+    // above sweep line that can be linked to a vertex below by a diagonal
+    // without crossing edges. Diagonals are added at split vertices and to
+    // merge vertices so that no vertex has both neighbours below or above it
+    // with a reflex angle
+    uint32_t l_nb_point = p_points.size();
+    std::vector<uint32_t> l_order(l_nb_point);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        l_order[l_index] = l_index;
+      }
+    std::sort(l_order.begin(),l_order.end(),[&](uint32_t p_index1,uint32_t p_index2) -> bool { return is_above(p_points[p_index1],p_points[p_index2]); });
+
+    point<T> l_query(p_points[0]);
+    std::set<uint32_t,status_less> l_status(status_less(p_points,l_query));
+    std::vector<uint32_t> l_helper(l_nb_point,0);
+    std::vector<bool> l_merge(l_nb_point,false);
+
+    auto l_left_edge = [&](uint32_t p_vertex) -> uint32_t
+      {
+        l_query = p_points[p_vertex];
+        typename std::set<uint32_t,status_less>::iterator l_iter = l_status.lower_bound(l_nb_point);
+        assert(l_status.begin() != l_iter);
+        return *(--l_iter);
+      };
+    auto l_link_merge_helper = [&](uint32_t p_vertex,uint32_t p_edge)
+      {
+        if(l_merge[l_helper[p_edge]])
+          {
+            p_diagonals.push_back(t_diagonal(p_vertex,l_helper[p_edge]));
+          }
+      };
+
+    for(auto l_vertex : l_order)
+      {
+        uint32_t l_previous = (l_vertex + l_nb_point - 1) % l_nb_point;
+        uint32_t l_next = (l_vertex + 1) % l_nb_point;
+        const point<T> & l_point = p_points[l_vertex];
+        bool l_previous_below = is_above(l_point,p_points[l_previous]);
+        bool l_next_below = is_above(l_point,p_points[l_next]);
+        bool l_convex = get_turn(p_points[l_previous],l_point,p_points[l_next]) > 0;
+        if(l_previous_below && l_next_below)
+          {
+            if(!l_convex)
+              {
+                // Split vertex
+                uint32_t l_edge = l_left_edge(l_vertex);
+                p_diagonals.push_back(t_diagonal(l_vertex,l_helper[l_edge]));
+                l_helper[l_edge] = l_vertex;
+              }
+            // Start vertex
+            l_helper[l_vertex] = l_vertex;
+            l_status.insert(l_vertex);
+          }
+        else if(!l_previous_below && !l_next_below)
+          {
+            // End or merge vertex
+            l_link_merge_helper(l_vertex,l_previous);
+            l_status.erase(l_previous);
+            if(!l_convex)
+              {
+                l_merge[l_vertex] = true;
+                uint32_t l_edge = l_left_edge(l_vertex);
+                l_link_merge_helper(l_vertex,l_edge);
+                l_helper[l_edge] = l_vertex;
+              }
+          }
+        else if(!l_previous_below)
+          {
+            // Regular vertex of left chain
+            l_link_merge_helper(l_vertex,l_previous);
+            l_status.erase(l_previous);
+            l_helper[l_vertex] = l_vertex;
+            l_status.insert(l_vertex);
+          }
+        else
+          {
+            // Regular vertex of right chain
+            uint32_t l_edge = l_left_edge(l_vertex);
+            l_link_merge_helper(l_vertex,l_edge);
+            l_helper[l_edge] = l_vertex;
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::add_fan(const std::vector<point<T>> & p_points,uint32_t p_apex,const std::vector<uint32_t> & p_chain,uint32_t p_first,uint32_t p_end,std::vector<t_diagonal> & p_diagonals)
+  {
+    const point<T> & l_apex = p_points[p_apex];
+    for(uint32_t l_index = p_first ; l_index < p_end ; ++l_index)
+      {
+        const point<T> & l_point = p_points[p_chain[l_index]];
+        bool l_previous_between = l_index && is_between(l_apex,p_points[p_chain[l_index - 1]],l_point);
+        bool l_next_between = l_index + 1 < p_chain.size() && is_between(l_apex,p_points[p_chain[l_index + 1]],l_point);
+        if(!l_previous_between && !l_next_between)
+          {
+            p_diagonals.push_back(t_diagonal(p_apex,p_chain[l_index]));
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::triangulate_monotone(const std::vector<point<T>> & p_points,const std::vector<uint32_t> & p_vertices,std::vector<t_diagonal> & p_diagonals)
+  {
+    uint32_t l_nb_vertex = p_vertices.size();
+    if(l_nb_vertex <= 3)
+      {
+        return;
+      }
+    uint32_t l_top = 0;
+    uint32_t l_bottom = 0;
+    for(uint32_t l_index = 1 ; l_index < l_nb_vertex ; ++l_index)
+      {
+        if(is_above(p_points[p_vertices[l_index]],p_points[p_vertices[l_top]])) l_top = l_index;
+        if(is_above(p_points[p_vertices[l_bottom]],p_points[p_vertices[l_index]])) l_bottom = l_index;
+      }
+
+    // Merge left chain, walked counterclockwise from top, and right chain
+    std::vector<uint32_t> l_sorted;
+    std::vector<bool> l_left;
+    l_sorted.reserve(l_nb_vertex);
+    l_left.reserve(l_nb_vertex);
+    l_sorted.push_back(p_vertices[l_top]);
+    l_left.push_back(true);
+    uint32_t l_left_index = (l_top + 1) % l_nb_vertex;
+    uint32_t l_right_index = (l_top + l_nb_vertex - 1) % l_nb_vertex;
+    while(l_left_index != l_bottom || l_right_index != l_bottom)
+      {
+        if(l_left_index != l_bottom && (l_right_index == l_bottom || is_above(p_points[p_vertices[l_left_index]],p_points[p_vertices[l_right_index]])))
+          {
+            l_sorted.push_back(p_vertices[l_left_index]);
+            l_left.push_back(true);
+            l_left_index = (l_left_index + 1) % l_nb_vertex;
+          }
+        else
+          {
+            l_sorted.push_back(p_vertices[l_right_index]);
+            l_left.push_back(false);
+            l_right_index = (l_right_index + l_nb_vertex - 1) % l_nb_vertex;
+          }
+      }
+    l_sorted.push_back(p_vertices[l_bottom]);
+    l_left.push_back(true);
+
+    // Stack contains a reflex chain of vertices waiting for diagonals
+    std::vector<uint32_t> l_stack;
+    std::vector<bool> l_stack_left;
+    l_stack.push_back(l_sorted[0]);
+    l_stack_left.push_back(l_left[0]);
+    l_stack.push_back(l_sorted[1]);
+    l_stack_left.push_back(l_left[1]);
+    for(uint32_t l_index = 2 ; l_index + 1 < l_nb_vertex ; ++l_index)
+      {
+        uint32_t l_vertex = l_sorted[l_index];
+        if(l_left[l_index] != l_stack_left.back())
+          {
+            // Vertex sees the whole stack which is on the other chain. Stack
+            // bottom is already linked to vertex
+            add_fan(p_points,l_vertex,l_stack,1,l_stack.size(),p_diagonals);
+            l_stack.assign(1,l_sorted[l_index - 1]);
+            l_stack_left.assign(1,l_left[l_index - 1]);
+          }
+        else
+          {
+            // Vertex sees stack vertices as long as chain is convex
+            uint32_t l_last = l_stack.back();
+            l_stack.pop_back();
+            l_stack_left.pop_back();
+            while(!l_stack.empty())
+              {
+                const point<T> & l_candidate = p_points[l_stack.back()];
+                int l_turn = l_left[l_index] ? get_turn(l_candidate,p_points[l_last],p_points[l_vertex]) : get_turn(p_points[l_vertex],p_points[l_last],l_candidate);
+                if(l_turn <= 0)
+                  {
+                    break;
+                  }
+                p_diagonals.push_back(t_diagonal(l_vertex,l_stack.back()));
+                l_last = l_stack.back();
+                l_stack.pop_back();
+                l_stack_left.pop_back();
+              }
+            l_stack.push_back(l_last);
+            l_stack_left.push_back(l_left[l_index]);
+          }
+        l_stack.push_back(l_vertex);
+        l_stack_left.push_back(l_left[l_index]);
+      }
+
+    // Bottom vertex sees remaining stack vertices
+    add_fan(p_points,l_sorted.back(),l_stack,1,l_stack.size() - 1,p_diagonals);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::link(const std::vector<point<T>> & p_points,const std::vector<t_diagonal> & p_diagonals,t_half_edges & p_half_edges)
+  {
+    uint32_t l_nb_point = p_points.size();
+    uint32_t l_nb_half_edge = 2 * (l_nb_point + p_diagonals.size());
+    p_half_edges.m_origin.resize(l_nb_half_edge);
+    p_half_edges.m_around_next.resize(l_nb_half_edge);
+    p_half_edges.m_around_prev.resize(l_nb_half_edge);
+    p_half_edges.m_removed.assign(l_nb_half_edge,false);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        p_half_edges.m_origin[2 * l_index] = l_index;
+        p_half_edges.m_origin[2 * l_index + 1] = (l_index + 1) % l_nb_point;
+      }
+    for(uint32_t l_index = 0 ; l_index < p_diagonals.size() ; ++l_index)
+      {
+        p_half_edges.m_origin[2 * (l_nb_point + l_index)] = p_diagonals[l_index].first;
+        p_half_edges.m_origin[2 * (l_nb_point + l_index) + 1] = p_diagonals[l_index].second;
+      }
+
+    // Group half edges by origin then sort each group by angle
+    std::vector<uint32_t> l_first(l_nb_point + 1,0);
+    for(auto l_origin : p_half_edges.m_origin)
+      {
+        ++l_first[l_origin + 1];
+      }
+    for(uint32_t l_index = 1 ; l_index <= l_nb_point ; ++l_index)
+      {
+        l_first[l_index] += l_first[l_index - 1];
+      }
+    std::vector<uint32_t> l_grouped(l_nb_half_edge);
+    std::vector<uint32_t> l_fill(l_first.begin(),l_first.end() - 1);
+    for(uint32_t l_half_edge = 0 ; l_half_edge < l_nb_half_edge ; ++l_half_edge)
+      {
+        l_grouped[l_fill[p_half_edges.m_origin[l_half_edge]]++] = l_half_edge;
+      }
+    auto l_angle_less = [&](uint32_t p_half_edge1,uint32_t p_half_edge2) -> bool
+      {
+        const point<T> & l_origin = p_points[p_half_edges.m_origin[p_half_edge1]];
+        const point<T> & l_dest1 = p_points[p_half_edges.m_origin[p_half_edge1 ^ 1]];
+        const point<T> & l_dest2 = p_points[p_half_edges.m_origin[p_half_edge2 ^ 1]];
+        T l_x1 = l_dest1.get_x() - l_origin.get_x();
+        T l_y1 = l_dest1.get_y() - l_origin.get_y();
+        T l_x2 = l_dest2.get_x() - l_origin.get_x();
+        T l_y2 = l_dest2.get_y() - l_origin.get_y();
+        bool l_lower1 = l_y1 < 0 || (l_y1 == 0 && l_x1 < 0);
+        bool l_lower2 = l_y2 < 0 || (l_y2 == 0 && l_x2 < 0);
+        return l_lower1 != l_lower2 ? l_lower2 : cross_product(l_x1,l_y1,l_x2,l_y2) > 0;
+      };
+    for(uint32_t l_vertex = 0 ; l_vertex < l_nb_point ; ++l_vertex)
+      {
+        uint32_t l_begin = l_first[l_vertex];
+        uint32_t l_end = l_first[l_vertex + 1];
+        std::sort(l_grouped.begin() + l_begin,l_grouped.begin() + l_end,l_angle_less);
+        for(uint32_t l_index = l_begin ; l_index < l_end ; ++l_index)
+          {
+            uint32_t l_next = l_index + 1 < l_end ? l_index + 1 : l_begin;
+            p_half_edges.m_around_next[l_grouped[l_index]] = l_grouped[l_next];
+            p_half_edges.m_around_prev[l_grouped[l_next]] = l_grouped[l_index];
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_partition<T>::is_convex_corner(const std::vector<point<T>> & p_points,const t_half_edges & p_half_edges,uint32_t p_half_edge)
+  {
+    // Angle between neighbour half edges, going counterclockwise through
+    // p_half_edge, is at most PI
+    const point<T> & l_origin = p_points[p_half_edges.m_origin[p_half_edge]];
+    const point<T> & l_previous = p_points[p_half_edges.m_origin[p_half_edges.m_around_prev[p_half_edge] ^ 1]];
+    const point<T> & l_next = p_points[p_half_edges.m_origin[p_half_edges.m_around_next[p_half_edge] ^ 1]];
+    int l_turn = get_turn(l_origin,l_previous,l_next);
+    return l_turn > 0 || (!l_turn && is_between(l_previous,l_origin,l_next));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::merge_pieces(const std::vector<point<T>> & p_points,t_half_edges & p_half_edges)
+  {
+    for(uint32_t l_half_edge = 2 * p_points.size() ; l_half_edge < p_half_edges.m_origin.size() ; l_half_edge += 2)
+      {
+        uint32_t l_twin = l_half_edge ^ 1;
+        if(!is_convex_corner(p_points,p_half_edges,l_half_edge) || !is_convex_corner(p_points,p_half_edges,l_twin))
+          {
+            continue;
+          }
+        for(auto l_iter : {l_half_edge,l_twin})
+          {
+            p_half_edges.m_around_next[p_half_edges.m_around_prev[l_iter]] = p_half_edges.m_around_next[l_iter];
+            p_half_edges.m_around_prev[p_half_edges.m_around_next[l_iter]] = p_half_edges.m_around_prev[l_iter];
+            p_half_edges.m_removed[l_iter] = true;
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::get_faces(const t_half_edges & p_half_edges,uint32_t p_nb_point,std::vector<uint32_t> & p_face_edges,std::vector<uint32_t> & p_face_first)
+  {
+    // Face on the left of half edge continues with the half edge preceding
+    // its twin around its destination. Outer face is the one of half edges
+    // 2i + 1
+    p_face_edges.clear();
+    p_face_first.assign(1,0);
+    std::vector<bool> l_visited(p_half_edges.m_origin.size(),false);
+    for(uint32_t l_start = 0 ; l_start < p_half_edges.m_origin.size() ; ++l_start)
+      {
+        if(l_visited[l_start] || p_half_edges.m_removed[l_start])
+          {
+            continue;
+          }
+        bool l_outer = l_start < 2 * p_nb_point && (l_start & 1);
+        uint32_t l_half_edge = l_start;
+        do
+          {
+            l_visited[l_half_edge] = true;
+            if(!l_outer)
+              {
+                p_face_edges.push_back(l_half_edge);
+              }
+            l_half_edge = p_half_edges.m_around_prev[l_half_edge ^ 1];
+          }
+        while(l_half_edge != l_start);
+        if(!l_outer)
+          {
+            p_face_first.push_back(p_face_edges.size());
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::build_grid(void)
+  {
+    if(m_pieces.empty())
+      {
+        return;
+      }
+    // Start with about one piece per cell. Long pieces overlap many cells so
+    // resolution is lowered until grid size stays linear in piece number
+    uint32_t l_size = std::max((uint32_t)1,(uint32_t)std::sqrt((double)m_pieces.size()));
+    while(true)
+      {
+        m_grid_width = m_grid_height = l_size;
+        m_cell_width = ((double)m_max_x - (double)m_min_x) / m_grid_width;
+        m_cell_height = ((double)m_max_y - (double)m_min_y) / m_grid_height;
+        uint64_t l_nb_entry = 0;
+        for(auto & l_piece : m_pieces)
+          {
+            l_nb_entry += ((uint64_t)(grid_x(l_piece.m_max_x) - grid_x(l_piece.m_min_x) + 1)) * (grid_y(l_piece.m_max_y) - grid_y(l_piece.m_min_y) + 1);
+          }
+        if(l_size == 1 || l_nb_entry <= 8 * (uint64_t)m_pieces.size())
+          {
+            break;
+          }
+        l_size /= 2;
+      }
+
+    // Count then fill cell piece lists
+    m_cell_first.assign(m_grid_width * m_grid_height + 1,0);
+    for(auto & l_piece : m_pieces)
+      {
+        for(uint32_t l_y = grid_y(l_piece.m_min_y) ; l_y <= grid_y(l_piece.m_max_y) ; ++l_y)
+          {
+            for(uint32_t l_x = grid_x(l_piece.m_min_x) ; l_x <= grid_x(l_piece.m_max_x) ; ++l_x)
+              {
+                ++m_cell_first[l_y * m_grid_width + l_x + 1];
+              }
+          }
+      }
+    for(uint32_t l_index = 1 ; l_index < m_cell_first.size() ; ++l_index)
+      {
+        m_cell_first[l_index] += m_cell_first[l_index - 1];
+      }
+    m_cell_ids.resize(m_cell_first.back());
+    std::vector<uint32_t> l_cell_fill(m_cell_first.begin(),m_cell_first.end() - 1);
+    for(uint32_t l_id = 0 ; l_id < m_pieces.size() ; ++l_id)
+      {
+        const t_piece & l_piece = m_pieces[l_id];
+        for(uint32_t l_y = grid_y(l_piece.m_min_y) ; l_y <= grid_y(l_piece.m_max_y) ; ++l_y)
+          {
+            for(uint32_t l_x = grid_x(l_piece.m_min_x) ; l_x <= grid_x(l_piece.m_max_x) ; ++l_x)
+              {
+                m_cell_ids[l_cell_fill[l_y * m_grid_width + l_x]++] = l_id;
+              }
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t convex_partition<T>::grid_x(const T & p_x)const
+  {
+    if(!(m_cell_width > 0))
+      {
+        return 0;
+      }
+    double l_x = ((double)p_x - (double)m_min_x) / m_cell_width;
+    return l_x < m_grid_width ? (uint32_t)l_x : m_grid_width - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t convex_partition<T>::grid_y(const T & p_y)const
+  {
+    if(!(m_cell_height > 0))
+      {
+        return 0;
+      }
+    double l_y = ((double)p_y - (double)m_min_y) / m_cell_height;
+    return l_y < m_grid_height ? (uint32_t)l_y : m_grid_height - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t convex_partition<T>::get_nb_piece(void)const
+  {
+    return m_pieces.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t convex_partition<T>::get_nb_edge(void)const
+  {
+    return m_coef_x.size() - m_pieces.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool convex_partition<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    // Point on a diagonal is inside polygon whatever p_consider_line, other
+    // border points are on polygon border
+    GEOMETRY_STATS_SCOPE(CONTAINS);
+    if(m_pieces.empty() || p.get_x() < m_min_x || m_max_x < p.get_x() || p.get_y() < m_min_y || m_max_y < p.get_y())
+      {
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+        return false;
+      }
+    uint32_t l_cell = grid_y(p.get_y()) * m_grid_width + grid_x(p.get_x());
+    for(uint32_t l_index = m_cell_first[l_cell] ; l_index < m_cell_first[l_cell + 1] ; ++l_index)
+      {
+        const t_piece & l_piece = m_pieces[m_cell_ids[l_index]];
+        if(p.get_x() < l_piece.m_min_x || l_piece.m_max_x < p.get_x() || p.get_y() < l_piece.m_min_y || l_piece.m_max_y < p.get_y())
+          {
+            continue;
+          }
+        GEOMETRY_STATS_ADD(CONVEX_NODE_VISIT,1);
+        uint32_t l_edge_index = 0;
+        const T * l_x = m_x.data() + l_piece.m_first_edge;
+        const T * l_y = m_y.data() + l_piece.m_first_edge;
+        const T * l_coef_x = m_coef_x.data() + l_piece.m_first_edge;
+        const T * l_coef_y = m_coef_y.data() + l_piece.m_first_edge;
+        t_convex_location l_location = (l_piece.m_nb_edge > convex_kernel<T>::wedge_threshold ?
+                                        convex_kernel<T>::wedge_locate(l_x,l_y,l_coef_x,l_coef_y,l_piece.m_nb_edge,p,l_edge_index) :
+                                        convex_kernel<T>::locate(l_x,l_y,l_coef_x,l_coef_y,l_piece.m_nb_edge,p,l_edge_index)
+                                        );
+        switch(l_location)
+          {
+          case t_convex_location::INSIDE:
+            return true;
+          case t_convex_location::OUTSIDE:
+            break;
+          case t_convex_location::VERTEX:
+            return p_consider_line;
+          case t_convex_location::BORDER:
+            return !m_polygon_segments[l_piece.m_first_edge + l_edge_index] || p_consider_line;
+          }
+      }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void convex_partition<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains(p_points[l_index],p_consider_line);
+      }
+  }
+}
+#endif // _CONVEX_PARTITION_HPP_
+//EOF
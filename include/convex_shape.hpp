@@ -21,8 +21,9 @@
 #include "point.hpp"
 #include "segment.hpp"
 #include "shape.hpp"
+#include "convex_kernel.hpp"
+#include "geometry_stats.hpp"
 #include <vector>
-#include <set>
 
 #include <iostream>
 
@@ -33,30 +34,77 @@ namespace geometry
   class convex_shape: public shape<T>
   {
   public:
+    // Algorithm used by contains : AUTO select wedge binary search above
+    // convex_kernel<T>::wedge_threshold edges and linear scan below
+    typedef enum class query_mode {AUTO=0,LINEAR,BINARY} t_query_mode;
+
     convex_shape(const point<T> & p1,const point<T> & p2,const point<T> & p3);
+    // Build shape from points already in hull order in a single pass
+    convex_shape(const std::vector<point<T>> & p_points);
+    convex_shape(std::vector<point<T>> && p_points);
+    template <typename ITERATOR>
+    convex_shape(ITERATOR p_begin,ITERATOR p_end);
     bool find(const point<T> & p)const;
+    // Safe to call concurrently as long as shape is not modified by add,
+    // define_polygon_segments or set_query_mode
     bool contains(const point<T> & p,bool p_consider_line=true)const;
+    // Position of point relatively to shape, ignoring polygon segments
+    t_convex_location locate(const point<T> & p)const;
     void define_polygon_segments(const std::vector<bool> & p_polygon_segments);
+    // Indicate if segment is also a segment of polygon wrapped by shape
+    bool is_polygon_segment(uint32_t p_index)const;
     bool add(const point<T> & p);
     void display_points(void)const;
+    void set_query_mode(t_query_mode p_mode);
   private:
-    std::set<point<T>> m_sorted_points;
+    // Build SoA edge table used by contains
+    void prepare_edges(void);
+    t_convex_location locate(const point<T> & p,uint32_t & p_edge_index)const;
+
     std::vector<bool> m_polygon_segments;
+    std::vector<T> m_x;
+    std::vector<T> m_y;
+    std::vector<T> m_coef_x;
+    std::vector<T> m_coef_y;
+    t_query_mode m_query_mode;
   };
 
   //------------------------------------------------------------------------------
   template <typename T> 
-  convex_shape<T>::convex_shape(const point<T> & p1,const point<T> & p2,const point<T> & p3)
+  convex_shape<T>::convex_shape(const point<T> & p1,const point<T> & p2,const point<T> & p3):
+    m_query_mode(t_query_mode::AUTO)
   {
     this->internal_add(p1);
     this->internal_add(p2);
     this->internal_add(p3);
-    m_sorted_points.insert(p1);
-    m_sorted_points.insert(p2);
-    m_sorted_points.insert(p3);
-    this->internal_add(segment<T>(p1,p2));
-    this->internal_add(segment<T>(p2,p3));
-    this->internal_add(segment<T>(p3,p1));
+    this->index_vertices();
+    prepare_edges();
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  convex_shape<T>::convex_shape(const std::vector<point<T>> & p_points):
+    convex_shape(std::vector<point<T>>(p_points))
+  {
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  template <typename ITERATOR>
+  convex_shape<T>::convex_shape(ITERATOR p_begin,ITERATOR p_end):
+    convex_shape(std::vector<point<T>>(p_begin,p_end))
+  {
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  convex_shape<T>::convex_shape(std::vector<point<T>> && p_points):
+    m_query_mode(t_query_mode::AUTO)
+  {
+    assert(p_points.size() >= 3);
+    this->internal_assign(std::move(p_points));
+    this->index_hull_vertices();
+    prepare_edges();
   }
 
   //------------------------------------------------------------------------------
@@ -67,41 +115,90 @@ namespace geometry
     m_polygon_segments = p_polygon_segments;
   }
 
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  bool convex_shape<T>::is_polygon_segment(uint32_t p_index)const
+  {
+    assert(p_index < this->get_nb_segment());
+    return !m_polygon_segments.size() || m_polygon_segments[p_index];
+  }
+
   //------------------------------------------------------------------------------
   template <typename T> 
   bool convex_shape<T>::find(const point<T> & p)const
   {
-    return m_sorted_points.find(p) != m_sorted_points.end();
+    return this->is_vertice(p);
+  }
+
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  t_convex_location convex_shape<T>::locate(const point<T> & p)const
+  {
+    uint32_t l_edge_index = 0;
+    return locate(p,l_edge_index);
   }
 
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  t_convex_location convex_shape<T>::locate(const point<T> & p,uint32_t & p_edge_index)const
+  {
+    bool l_binary = t_query_mode::BINARY == m_query_mode || (t_query_mode::AUTO == m_query_mode && this->get_nb_segment() > convex_kernel<T>::wedge_threshold);
+    return (l_binary ?
+            convex_kernel<T>::wedge_locate(m_x.data(),m_y.data(),m_coef_x.data(),m_coef_y.data(),this->get_nb_segment(),p,p_edge_index) :
+            convex_kernel<T>::locate(m_x.data(),m_y.data(),m_coef_x.data(),m_coef_y.data(),this->get_nb_segment(),p,p_edge_index)
+            );
+  }
 
   //------------------------------------------------------------------------------
   template <typename T> 
   bool convex_shape<T>::contains(const point<T> & p,bool p_consider_line)const
   {
-#ifdef DEBUG
-    std::cout << "Contains test of convex shape " << *this << " for point " << p << " consider line " << p_consider_line << std::endl;
-#endif
-    T l_orient = 0;
-    bool l_contain = true;
-    for(unsigned int l_index = 0 ; l_index < this->get_nb_segment() && l_contain ; ++ l_index)
+    GEOMETRY_STATS_ADD(CONVEX_NODE_VISIT,1);
+    uint32_t l_edge_index = 0;
+    t_convex_location l_location = locate(p,l_edge_index);
+    switch(l_location)
+      {
+      case t_convex_location::INSIDE:
+        return true;
+      case t_convex_location::OUTSIDE:
+        return false;
+      case t_convex_location::VERTEX:
+        return p_consider_line;
+      case t_convex_location::BORDER:
+        return p_consider_line && (!m_polygon_segments.size() || m_polygon_segments[l_edge_index]);
+      }
+    return false;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void convex_shape<T>::set_query_mode(t_query_mode p_mode)
+  {
+    m_query_mode = p_mode;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void convex_shape<T>::prepare_edges(void)
+  {
+    uint32_t l_nb_point = this->get_nb_point();
+    m_x.resize(l_nb_point + 1);
+    m_y.resize(l_nb_point + 1);
+    m_coef_x.resize(l_nb_point);
+    m_coef_y.resize(l_nb_point);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        m_x[l_index] = this->get_point(l_index).get_x();
+        m_y[l_index] = this->get_point(l_index).get_y();
+      }
+    m_x[l_nb_point] = m_x[0];
+    m_y[l_nb_point] = m_y[0];
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
       {
-        const segment<T> & l_ref_segment = this->get_segment(l_index);
-#ifdef DEBUG
-        std::cout << l_ref_segment << std::endl ;
-#endif
-        if(p == l_ref_segment.get_source() || p == l_ref_segment.get_dest())
-          {
-            return p_consider_line;
-          }
-        T l_vectorial_product = l_ref_segment.vectorial_product(segment<T>(l_ref_segment.get_source(),p));
-        if(!l_vectorial_product && ((l_ref_segment.get_min_x() < p.get_x() && p.get_x() < l_ref_segment.get_max_x()) || (l_ref_segment.get_min_y() < p.get_y() && p.get_y() < l_ref_segment.get_max_y())))
-          {
-            return p_consider_line && (!m_polygon_segments.size() || m_polygon_segments[l_index]);
-          }
-	l_contain = segment<T>::check_convex_continuation(l_vectorial_product,l_orient,l_index == 0);
+        m_coef_x[l_index] = m_x[l_index + 1] - m_x[l_index];
+        m_coef_y[l_index] = m_y[l_index + 1] - m_y[l_index];
       }
-    return l_contain;
   }
 
   //------------------------------------------------------------------------------
@@ -124,16 +221,15 @@ namespace geometry
       {
 	// Get a third point outside of segment
 	point<T> l_third_point = this->get_point((l_segment_index + 2) % this->get_nb_point());
-	T l_vector_produc = this->get_segment(l_segment_index).vectorial_product(segment<T>(this->get_point(l_segment_index),l_third_point));
+	typename segment<T>::t_wide l_vector_produc = this->get_segment(l_segment_index).vectorial_product(segment<T>(this->get_point(l_segment_index),l_third_point));
 	l_convex = segment<T>::check_convex_continuation(this->get_segment(l_segment_index).vectorial_product(segment<T>(this->get_point(l_segment_index),p)),l_vector_produc,l_segment_index==0);
       }
     if(!l_convex) return false;
 
     // Create temporary segment between latest point and new point
     segment<T> l_tmp_segment1(this->get_point(this->get_nb_point()-1),p);
-    segment<T> l_tmp_segment2(p,this->get_point(0));
 
-    T l_orient = 0;
+    typename segment<T>::t_wide l_orient = 0;
     for(unsigned int l_point_index = 1 ; l_point_index < this->get_nb_point() - 1;++l_point_index)
       {
 	l_convex = segment<T>::check_convex_continuation(l_tmp_segment1.vectorial_product(segment<T>(this->get_point(this->get_nb_point()-1),this->get_point(l_point_index))),l_orient,l_point_index == 1);
@@ -146,11 +242,9 @@ namespace geometry
       }
     if(!l_convex) return false;
 
-    this->remove_last_segment();
-    this->internal_add(l_tmp_segment1);
-    this->internal_add(l_tmp_segment2);
     this->internal_add(p);
-    m_sorted_points.insert(p);
+    this->index_vertices();
+    prepare_edges();
     return true;
   }
 }
@@ -0,0 +1,199 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _CROSSING_POLYGON_HPP_
+#define _CROSSING_POLYGON_HPP_
+
+#include "point.hpp"
+#include "segment.hpp"
+#include "shape.hpp"
+#include "geometry_stats.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cinttypes>
+
+namespace geometry
+{
+  // Containment engine needing no decomposition : edges are sorted by
+  // minimum y once in O(n log n) and a query counts crossings of an
+  // horizontal ray with the edges spanning its y. Edges whose minimum y is
+  // not above point y form a prefix of the table, the ones also reaching
+  // point y are found through a tree storing maximum y of blocks of edges.
+  // Engine is immutable : queries can be shared between threads
+  template <typename T=double>
+  class crossing_polygon
+  {
+  public:
+    inline crossing_polygon(const shape<T> & p_shape);
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+  private:
+    // Edges are checked by blocks at tree leaves
+    static const uint32_t m_block_size = 16;
+
+    T m_min_x;
+    T m_max_x;
+    T m_min_y;
+    T m_max_y;
+
+    // Edges sorted by minimum y
+    std::vector<segment<T>> m_segments;
+    std::vector<T> m_edge_min_y;
+    std::vector<T> m_edge_max_y;
+
+    // Implicit binary tree : node i has children 2i and 2i + 1, leaf
+    // m_nb_leaf + b being block b of edges. Each node stores maximum of
+    // edge maximum y below it
+    uint32_t m_nb_leaf;
+    std::vector<T> m_tree;
+  };
+
+  template <typename T>
+  const uint32_t crossing_polygon<T>::m_block_size;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  crossing_polygon<T>::crossing_polygon(const shape<T> & p_shape):
+    m_min_x(p_shape.get_min_x()),
+    m_max_x(p_shape.get_max_x()),
+    m_min_y(p_shape.get_min_y()),
+    m_max_y(p_shape.get_max_y()),
+    m_nb_leaf(1)
+  {
+    uint32_t l_nb_segment = p_shape.get_nb_segment();
+    m_segments.reserve(l_nb_segment);
+    for(uint32_t l_index = 0 ; l_index < l_nb_segment ; ++l_index)
+      {
+        m_segments.push_back(p_shape.get_segment(l_index));
+      }
+    std::sort(m_segments.begin(),m_segments.end(),[](const segment<T> & p_segment1,const segment<T> & p_segment2) -> bool { return p_segment1.get_min_y() < p_segment2.get_min_y(); });
+    m_edge_min_y.reserve(l_nb_segment);
+    m_edge_max_y.reserve(l_nb_segment);
+    for(auto & l_iter : m_segments)
+      {
+        m_edge_min_y.push_back(l_iter.get_min_y());
+        m_edge_max_y.push_back(l_iter.get_max_y());
+      }
+
+    uint32_t l_nb_block = (l_nb_segment + m_block_size - 1) / m_block_size;
+    while(m_nb_leaf < l_nb_block)
+      {
+        m_nb_leaf *= 2;
+      }
+    m_tree.assign(2 * m_nb_leaf,std::numeric_limits<T>::lowest());
+    for(uint32_t l_index = 0 ; l_index < l_nb_segment ; ++l_index)
+      {
+        T & l_leaf = m_tree[m_nb_leaf + l_index / m_block_size];
+        l_leaf = std::max(l_leaf,m_edge_max_y[l_index]);
+      }
+    for(uint32_t l_node = m_nb_leaf - 1 ; l_node > 0 ; --l_node)
+      {
+        m_tree[l_node] = std::max(m_tree[2 * l_node],m_tree[2 * l_node + 1]);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool crossing_polygon<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    GEOMETRY_STATS_SCOPE(CONTAINS);
+    if(p.get_x() < m_min_x || m_max_x < p.get_x() || p.get_y() < m_min_y || m_max_y < p.get_y())
+      {
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+        return false;
+      }
+    const T & l_y = p.get_y();
+    uint32_t l_end = std::upper_bound(m_edge_min_y.begin(),m_edge_min_y.end(),l_y) - m_edge_min_y.begin();
+    uint32_t l_end_block = (l_end + m_block_size - 1) / m_block_size;
+
+    // Depth first walk of nodes covering blocks before l_end_block and
+    // reaching point y. Node first block and block number are deduced from
+    // its level
+    uint32_t l_stack[2 * 32];
+    uint32_t l_stack_size = 0;
+    l_stack[l_stack_size++] = 1;
+    bool l_inside = false;
+    while(l_stack_size)
+      {
+        uint32_t l_node = l_stack[--l_stack_size];
+        if(m_tree[l_node] < l_y)
+          {
+            continue;
+          }
+        uint32_t l_level_size = 1;
+        while(2 * l_level_size <= l_node)
+          {
+            l_level_size *= 2;
+          }
+        uint32_t l_nb_node_block = m_nb_leaf / l_level_size;
+        uint32_t l_first_block = (l_node - l_level_size) * l_nb_node_block;
+        if(l_first_block >= l_end_block)
+          {
+            continue;
+          }
+        if(l_node < m_nb_leaf)
+          {
+            l_stack[l_stack_size++] = 2 * l_node + 1;
+            l_stack[l_stack_size++] = 2 * l_node;
+            continue;
+          }
+
+        // Leaf : edges of block spanning point y
+        uint32_t l_block_end = std::min(l_end,(l_first_block + 1) * m_block_size);
+        for(uint32_t l_index = l_first_block * m_block_size ; l_index < l_block_end ; ++l_index)
+          {
+            if(m_edge_max_y[l_index] < l_y)
+              {
+                continue;
+              }
+            GEOMETRY_STATS_ADD(EDGE_TEST,1);
+            const segment<T> & l_segment = m_segments[l_index];
+            if(l_segment.belong(p))
+              {
+                return p_consider_line;
+              }
+            // Half open rule : edge crosses horizontal line at point y if
+            // one end is above it and the other is not. Crossing is on the
+            // right of point if point is on the left of edge going upward
+            if(l_y < m_edge_max_y[l_index])
+              {
+                bool l_upward = l_segment.get_source().get_y() < l_segment.get_dest().get_y();
+                typename segment<T>::t_wide l_side = l_segment.get_side(p);
+                if(l_upward ? l_side > 0 : l_side < 0)
+                  {
+                    l_inside = !l_inside;
+                  }
+              }
+          }
+      }
+    return l_inside;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void crossing_polygon<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains(p_points[l_index],p_consider_line);
+      }
+  }
+}
+#endif // _CROSSING_POLYGON_HPP_
+//EOF
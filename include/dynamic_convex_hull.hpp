@@ -0,0 +1,189 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _DYNAMIC_CONVEX_HULL_HPP_
+#define _DYNAMIC_CONVEX_HULL_HPP_
+
+#include "point.hpp"
+#include "convex_shape.hpp"
+#include "arithmetic_traits.hpp"
+#include <map>
+#include <vector>
+#include <iterator>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Strict convex hull of a growing point set. Hull is stored as its upper
+  // and lower chains, each one being a map from x to y of its vertices, so
+  // that a point is located in O(log n) and each insertion removes the
+  // vertices it makes obsolete in amortized O(log n)
+  template <typename T=double>
+  class dynamic_convex_hull
+  {
+  public:
+    inline dynamic_convex_hull(void);
+    // Return false if point is inside hull or on its border, in this case
+    // hull is not modified
+    inline bool add(const point<T> & p);
+    inline uint32_t get_nb_vertex(void)const;
+    // Hull vertices in counterclockwise order starting from minimum point
+    inline std::vector<point<T>> get_vertices(void)const;
+    // Shape usable by convex_shape::contains. Hull must have at least 3
+    // vertices
+    inline convex_shape<T> get_snapshot(void)const;
+  private:
+    typedef std::map<T,T> t_chain;
+
+    // Upper chain is kept turning clockwise from left to right
+    // (p_sign = 1), lower chain counterclockwise (p_sign = -1)
+    inline static bool add(t_chain & p_chain,const T & p_x,const T & p_y,int p_sign);
+    inline static int get_turn(const T & p_x1,const T & p_y1,const T & p_x2,const T & p_y2,const T & p_x3,const T & p_y3);
+
+    t_chain m_upper;
+    t_chain m_lower;
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  dynamic_convex_hull<T>::dynamic_convex_hull(void)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int dynamic_convex_hull<T>::get_turn(const T & p_x1,const T & p_y1,const T & p_x2,const T & p_y2,const T & p_x3,const T & p_y3)
+  {
+    return get_sign(cross_product(p_x2 - p_x1,p_y2 - p_y1,p_x3 - p_x1,p_y3 - p_y1));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool dynamic_convex_hull<T>::add(t_chain & p_chain,const T & p_x,const T & p_y,int p_sign)
+  {
+    typename t_chain::iterator l_iter = p_chain.lower_bound(p_x);
+    if(p_chain.end() != l_iter && p_x == l_iter->first)
+      {
+        if(p_sign * get_sign(p_y - l_iter->second) <= 0)
+          {
+            return false;
+          }
+        // Vertex with same x is replaced
+        l_iter = p_chain.erase(l_iter);
+      }
+    else if(p_chain.end() != l_iter && p_chain.begin() != l_iter)
+      {
+        // Point between two vertices has to be strictly beyond their edge
+        typename t_chain::iterator l_previous = std::prev(l_iter);
+        if(p_sign * get_turn(l_previous->first,l_previous->second,l_iter->first,l_iter->second,p_x,p_y) <= 0)
+          {
+            return false;
+          }
+      }
+    l_iter = p_chain.insert(l_iter,std::make_pair(p_x,p_y));
+
+    // Splice out vertices that no longer turn in chain direction
+    while(p_chain.begin() != l_iter)
+      {
+        typename t_chain::iterator l_previous = std::prev(l_iter);
+        if(p_chain.begin() == l_previous)
+          {
+            break;
+          }
+        typename t_chain::iterator l_before_previous = std::prev(l_previous);
+        if(p_sign * get_turn(l_before_previous->first,l_before_previous->second,l_previous->first,l_previous->second,p_x,p_y) < 0)
+          {
+            break;
+          }
+        p_chain.erase(l_previous);
+      }
+    while(true)
+      {
+        typename t_chain::iterator l_next = std::next(l_iter);
+        if(p_chain.end() == l_next || p_chain.end() == std::next(l_next))
+          {
+            break;
+          }
+        typename t_chain::iterator l_after_next = std::next(l_next);
+        if(p_sign * get_turn(p_x,p_y,l_next->first,l_next->second,l_after_next->first,l_after_next->second) < 0)
+          {
+            break;
+          }
+        p_chain.erase(l_next);
+      }
+    return true;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool dynamic_convex_hull<T>::add(const point<T> & p)
+  {
+    bool l_upper = add(m_upper,p.get_x(),p.get_y(),1);
+    bool l_lower = add(m_lower,p.get_x(),p.get_y(),-1);
+    return l_upper || l_lower;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t dynamic_convex_hull<T>::get_nb_vertex(void)const
+  {
+    if(m_upper.empty())
+      {
+        return 0;
+      }
+    // Chains share their extremities unless hull has vertical edges there
+    uint32_t l_nb_vertex = m_upper.size() + m_lower.size();
+    l_nb_vertex -= m_upper.begin()->second == m_lower.begin()->second;
+    if(m_upper.size() > 1)
+      {
+        l_nb_vertex -= m_upper.rbegin()->second == m_lower.rbegin()->second;
+      }
+    return l_nb_vertex;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> dynamic_convex_hull<T>::get_vertices(void)const
+  {
+    std::vector<point<T>> l_vertices;
+    l_vertices.reserve(get_nb_vertex());
+    for(auto & l_iter : m_lower)
+      {
+        l_vertices.push_back(point<T>(l_iter.first,l_iter.second));
+      }
+    for(auto l_iter = m_upper.rbegin() ; m_upper.rend() != l_iter ; ++l_iter)
+      {
+        point<T> l_point(l_iter->first,l_iter->second);
+        if(!(l_point == l_vertices.back()) && !(l_point == l_vertices.front()))
+          {
+            l_vertices.push_back(l_point);
+          }
+      }
+    return l_vertices;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  convex_shape<T> dynamic_convex_hull<T>::get_snapshot(void)const
+  {
+    assert(get_nb_vertex() >= 3);
+    return convex_shape<T>(get_vertices());
+  }
+}
+#endif // _DYNAMIC_CONVEX_HULL_HPP_
+//EOF
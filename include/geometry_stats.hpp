@@ -0,0 +1,264 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _GEOMETRY_STATS_HPP_
+#define _GEOMETRY_STATS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <cinttypes>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Hot path instrumentation is compiled only when GEOMETRY_STATS is defined.
+// Otherwise macros expand to nothing and query path is left untouched
+#ifdef GEOMETRY_STATS
+#define GEOMETRY_STATS_ADD(counter,value) geometry::stats::add(geometry::stats::t_counter::counter,value)
+#define GEOMETRY_STATS_SCOPE(phase) geometry::stats::scope l_stats_scope(geometry::stats::t_phase::phase)
+#else
+#define GEOMETRY_STATS_ADD(counter,value)
+#define GEOMETRY_STATS_SCOPE(phase)
+#endif
+
+namespace geometry
+{
+  // Process wide counters and latency histograms. Counters are atomics
+  // updated with relaxed ordering so that concurrent queries can be counted
+  class stats
+  {
+  public:
+    typedef enum class counter {QUERY=0,BBOX_REJECTION,CONVEX_NODE_VISIT,EDGE_TEST,RECURSION_DEPTH,NB_COUNTER} t_counter;
+    typedef enum class phase {CONTAINS=0,IS_CONVEX,CUT_IN_CONVEX_POLYGON,NB_PHASE} t_phase;
+
+    // Bucket i of histograms counts durations in [2^i,2^(i+1)) cycles
+    static const uint32_t nb_bucket = 48;
+    static const uint32_t nb_counter = (uint32_t)t_counter::NB_COUNTER;
+    static const uint32_t nb_phase = (uint32_t)t_phase::NB_PHASE;
+
+    typedef struct
+    {
+      uint64_t m_counters[nb_counter];
+      // Deepest level of outside polygons reached by a query
+      uint64_t m_max_recursion_depth;
+      uint64_t m_histograms[nb_phase][nb_bucket];
+    } t_snapshot;
+
+    // Measure duration of a phase. Nested scopes of the same phase, as in
+    // recursive calls, are part of the outermost one. For CONTAINS phase the
+    // outermost scope is a query whose recursion depth is recorded
+    class scope
+    {
+    public:
+      inline scope(t_phase p_phase);
+      inline ~scope(void);
+    private:
+      t_phase m_phase;
+      uint64_t m_start;
+    };
+
+    inline static void add(t_counter p_counter,uint64_t p_value);
+    inline static void reset(void);
+    inline static t_snapshot get_snapshot(void);
+    inline static std::string to_json(const t_snapshot & p_snapshot);
+    // Time stamp counter when available, nanoseconds otherwise
+    inline static uint64_t get_cycles(void);
+  private:
+    typedef struct
+    {
+      std::atomic<uint64_t> m_counters[nb_counter];
+      std::atomic<uint64_t> m_max_recursion_depth;
+      std::atomic<uint64_t> m_histograms[nb_phase][nb_bucket];
+    } t_storage;
+
+    inline static t_storage & get_storage(void);
+    // Nesting level of each phase for current thread
+    inline static uint32_t * get_nesting(void);
+    // Deepest nesting of CONTAINS reached by current query of current thread
+    inline static uint32_t & get_query_depth(void);
+    inline static void record(t_phase p_phase,uint64_t p_duration);
+  };
+
+  //----------------------------------------------------------------------------
+  stats::t_storage & stats::get_storage(void)
+  {
+    // Zero initialized as object with static storage duration
+    static t_storage l_storage;
+    return l_storage;
+  }
+
+  //----------------------------------------------------------------------------
+  uint32_t * stats::get_nesting(void)
+  {
+    static thread_local uint32_t l_nesting[nb_phase] = {0};
+    return l_nesting;
+  }
+
+  //----------------------------------------------------------------------------
+  uint32_t & stats::get_query_depth(void)
+  {
+    static thread_local uint32_t l_depth = 0;
+    return l_depth;
+  }
+
+  //----------------------------------------------------------------------------
+  uint64_t stats::get_cycles(void)
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+  }
+
+  //----------------------------------------------------------------------------
+  void stats::add(t_counter p_counter,uint64_t p_value)
+  {
+    get_storage().m_counters[(uint32_t)p_counter].fetch_add(p_value,std::memory_order_relaxed);
+  }
+
+  //----------------------------------------------------------------------------
+  void stats::record(t_phase p_phase,uint64_t p_duration)
+  {
+    uint32_t l_bucket = 0;
+    while(p_duration > 1 && l_bucket < nb_bucket - 1)
+      {
+        p_duration >>= 1;
+        ++l_bucket;
+      }
+    get_storage().m_histograms[(uint32_t)p_phase][l_bucket].fetch_add(1,std::memory_order_relaxed);
+  }
+
+  //----------------------------------------------------------------------------
+  void stats::reset(void)
+  {
+    t_storage & l_storage = get_storage();
+    for(uint32_t l_index = 0 ; l_index < nb_counter ; ++l_index)
+      {
+        l_storage.m_counters[l_index].store(0,std::memory_order_relaxed);
+      }
+    l_storage.m_max_recursion_depth.store(0,std::memory_order_relaxed);
+    for(uint32_t l_phase = 0 ; l_phase < nb_phase ; ++l_phase)
+      {
+        for(uint32_t l_bucket = 0 ; l_bucket < nb_bucket ; ++l_bucket)
+          {
+            l_storage.m_histograms[l_phase][l_bucket].store(0,std::memory_order_relaxed);
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  stats::t_snapshot stats::get_snapshot(void)
+  {
+    t_storage & l_storage = get_storage();
+    t_snapshot l_snapshot;
+    for(uint32_t l_index = 0 ; l_index < nb_counter ; ++l_index)
+      {
+        l_snapshot.m_counters[l_index] = l_storage.m_counters[l_index].load(std::memory_order_relaxed);
+      }
+    l_snapshot.m_max_recursion_depth = l_storage.m_max_recursion_depth.load(std::memory_order_relaxed);
+    for(uint32_t l_phase = 0 ; l_phase < nb_phase ; ++l_phase)
+      {
+        for(uint32_t l_bucket = 0 ; l_bucket < nb_bucket ; ++l_bucket)
+          {
+            l_snapshot.m_histograms[l_phase][l_bucket] = l_storage.m_histograms[l_phase][l_bucket].load(std::memory_order_relaxed);
+          }
+      }
+    return l_snapshot;
+  }
+
+  //----------------------------------------------------------------------------
+  std::string stats::to_json(const t_snapshot & p_snapshot)
+  {
+    const char * l_counter_names[nb_counter] = {"query","bbox_rejection","convex_node_visit","edge_test","recursion_depth"};
+    const char * l_phase_names[nb_phase] = {"contains","is_convex","cut_in_convex_polygon"};
+    std::ostringstream l_stream;
+    l_stream << "{\"counters\":{";
+    for(uint32_t l_index = 0 ; l_index < nb_counter ; ++l_index)
+      {
+        l_stream << (l_index ? "," : "") << "\"" << l_counter_names[l_index] << "\":" << p_snapshot.m_counters[l_index];
+      }
+    l_stream << ",\"max_recursion_depth\":" << p_snapshot.m_max_recursion_depth << "}";
+    // Averages per query
+    uint64_t l_nb_query = p_snapshot.m_counters[(uint32_t)t_counter::QUERY];
+    l_stream << ",\"per_query\":{";
+    for(uint32_t l_index = 1 ; l_index < nb_counter ; ++l_index)
+      {
+        l_stream << (l_index > 1 ? "," : "") << "\"" << l_counter_names[l_index] << "\":" << (l_nb_query ? ((double)p_snapshot.m_counters[l_index]) / l_nb_query : 0.0);
+      }
+    l_stream << "},\"histograms\":{";
+    for(uint32_t l_phase = 0 ; l_phase < nb_phase ; ++l_phase)
+      {
+        // Buckets are trimmed after the last non empty one
+        uint32_t l_nb_bucket = nb_bucket;
+        while(l_nb_bucket && !p_snapshot.m_histograms[l_phase][l_nb_bucket - 1])
+          {
+            --l_nb_bucket;
+          }
+        l_stream << (l_phase ? "," : "") << "\"" << l_phase_names[l_phase] << "\":[";
+        for(uint32_t l_bucket = 0 ; l_bucket < l_nb_bucket ; ++l_bucket)
+          {
+            l_stream << (l_bucket ? "," : "") << p_snapshot.m_histograms[l_phase][l_bucket];
+          }
+        l_stream << "]";
+      }
+    l_stream << "}}";
+    return l_stream.str();
+  }
+
+  //----------------------------------------------------------------------------
+  stats::scope::scope(t_phase p_phase):
+    m_phase(p_phase),
+    m_start(0)
+  {
+    uint32_t l_nesting = ++get_nesting()[(uint32_t)m_phase];
+    if(1 == l_nesting)
+      {
+        m_start = get_cycles();
+      }
+    if(t_phase::CONTAINS == m_phase && l_nesting - 1 > get_query_depth())
+      {
+        get_query_depth() = l_nesting - 1;
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  stats::scope::~scope(void)
+  {
+    if(--get_nesting()[(uint32_t)m_phase])
+      {
+        return;
+      }
+    record(m_phase,get_cycles() - m_start);
+    if(t_phase::CONTAINS == m_phase)
+      {
+        uint64_t l_depth = get_query_depth();
+        get_query_depth() = 0;
+        add(t_counter::QUERY,1);
+        add(t_counter::RECURSION_DEPTH,l_depth);
+        std::atomic<uint64_t> & l_max = get_storage().m_max_recursion_depth;
+        uint64_t l_current = l_max.load(std::memory_order_relaxed);
+        while(l_current < l_depth && !l_max.compare_exchange_weak(l_current,l_depth,std::memory_order_relaxed))
+          {
+          }
+      }
+  }
+}
+#endif // _GEOMETRY_STATS_HPP_
+//EOF
@@ -0,0 +1,423 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _POINT_STREAM_HPP_
+#define _POINT_STREAM_HPP_
+
+#include "point.hpp"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cerrno>
+#include <cinttypes>
+#include <cassert>
+#include <unistd.h>
+
+namespace geometry
+{
+  // Sequence of points read by fixed size chunks from a file descriptor or
+  // from a memory region such as a mapped file. While a chunk is processed
+  // the next one is read by another thread in a second buffer so memory use
+  // only depends on chunk size.
+  // BINARY format is a sequence of x and y values of type T in native
+  // endianness. CSV format has one point per line, x and y being separated
+  // by a comma, a semicolon or blanks. Empty lines are skipped
+  template <typename T=double>
+  class point_stream
+  {
+  public:
+    typedef enum class format {BINARY=0,CSV} t_format;
+
+    inline point_stream(int p_fd,t_format p_format,uint32_t p_chunk_size=65536);
+    inline point_stream(const void * p_data,size_t p_size,t_format p_format,uint32_t p_chunk_size=65536);
+
+    // Call p_process(const point<T> *,uint32_t) for each chunk in stream
+    // order. Return number of points processed. Chunks are read by a single
+    // thread living for the whole call. Exceptions thrown by p_process or
+    // by reading are propagated once this thread has been joined
+    template <typename PROCESS>
+    inline uint64_t for_each_chunk(PROCESS p_process);
+
+    // Classify each chunk with batch contains of SHAPE then give results to
+    // p_sink(const point<T> *,uint32_t,const std::vector<bool> &)
+    template <typename SHAPE,typename SINK>
+    inline uint64_t classify(const SHAPE & p_shape,SINK p_sink,bool p_consider_line=true);
+
+    // Set when stream stopped on a read error, a truncated binary point or
+    // a malformed CSV line, including values out of T range, nan or infinity
+    inline bool has_error(void)const;
+  private:
+    // Longest CSV line accepted
+    static const uint32_t m_max_line_size = 128;
+
+    inline uint32_t read_chunk(std::vector<point<T>> & p_points);
+    inline uint32_t read_binary(std::vector<point<T>> & p_points);
+    inline uint32_t read_csv(std::vector<point<T>> & p_points);
+    // Make at least p_size bytes available in m_input unless stream ends.
+    // Return number of bytes available
+    inline size_t fill(size_t p_size);
+    // p_empty is set for blank lines, which are not errors
+    inline static bool parse_line(const char * p_begin,const char * p_end,T & p_x,T & p_y,bool & p_empty);
+    inline static bool parse_value(const char * & p_cursor,T & p_value);
+
+    int m_fd;
+    const char * m_data;
+    t_format m_format;
+    uint32_t m_chunk_size;
+    bool m_error;
+    bool m_end;
+
+    // Input bytes not consumed yet are in [m_position, m_input_end) of
+    // m_input for file descriptor, of m_data for memory region
+    std::vector<char> m_input;
+    size_t m_position;
+    size_t m_input_end;
+
+    std::vector<point<T>> m_buffers[2];
+  };
+
+  template <typename T>
+  const uint32_t point_stream<T>::m_max_line_size;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  point_stream<T>::point_stream(int p_fd,t_format p_format,uint32_t p_chunk_size):
+    m_fd(p_fd),
+    m_data(nullptr),
+    m_format(p_format),
+    m_chunk_size(p_chunk_size),
+    m_error(false),
+    m_end(false),
+    m_input(std::max((size_t)p_chunk_size * 2 * sizeof(T),(size_t)2 * m_max_line_size)),
+    m_position(0),
+    m_input_end(0)
+  {
+    assert(p_chunk_size);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  point_stream<T>::point_stream(const void * p_data,size_t p_size,t_format p_format,uint32_t p_chunk_size):
+    m_fd(-1),
+    m_data(static_cast<const char *>(p_data)),
+    m_format(p_format),
+    m_chunk_size(p_chunk_size),
+    m_error(false),
+    m_end(true),
+    m_position(0),
+    m_input_end(p_size)
+  {
+    assert(p_chunk_size);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool point_stream<T>::has_error(void)const
+  {
+    return m_error;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  template <typename PROCESS>
+  uint64_t point_stream<T>::for_each_chunk(PROCESS p_process)
+  {
+    // Buffers are handed over under mutex : l_filled[i] is set by reader
+    // once m_buffers[i] holds l_nb_read[i] points, a null count ending the
+    // stream, and cleared by processing once buffer can be reused
+    std::mutex l_mutex;
+    std::condition_variable l_condition;
+    bool l_filled[2] = {false,false};
+    uint32_t l_nb_read[2] = {0,0};
+    bool l_stop = false;
+    std::exception_ptr l_read_exception;
+
+    std::thread l_reader([&]()
+                         {
+                           for(uint32_t l_buffer = 0 ; ; l_buffer = 1 - l_buffer)
+                             {
+                               {
+                                 std::unique_lock<std::mutex> l_lock(l_mutex);
+                                 l_condition.wait(l_lock,[&]() { return l_stop || !l_filled[l_buffer]; });
+                                 if(l_stop)
+                                   {
+                                     return;
+                                   }
+                               }
+                               uint32_t l_nb = 0;
+                               try
+                                 {
+                                   l_nb = read_chunk(m_buffers[l_buffer]);
+                                 }
+                               catch(...)
+                                 {
+                                   l_read_exception = std::current_exception();
+                                 }
+                               {
+                                 std::lock_guard<std::mutex> l_lock(l_mutex);
+                                 l_nb_read[l_buffer] = l_nb;
+                                 l_filled[l_buffer] = true;
+                               }
+                               l_condition.notify_all();
+                               if(!l_nb)
+                                 {
+                                   return;
+                                 }
+                             }
+                         });
+
+    uint64_t l_nb_point = 0;
+    try
+      {
+        for(uint32_t l_buffer = 0 ; ; l_buffer = 1 - l_buffer)
+          {
+            uint32_t l_nb;
+            {
+              std::unique_lock<std::mutex> l_lock(l_mutex);
+              l_condition.wait(l_lock,[&]() { return l_filled[l_buffer]; });
+              l_nb = l_nb_read[l_buffer];
+            }
+            if(!l_nb)
+              {
+                break;
+              }
+            p_process(m_buffers[l_buffer].data(),l_nb);
+            l_nb_point += l_nb;
+            {
+              std::lock_guard<std::mutex> l_lock(l_mutex);
+              l_filled[l_buffer] = false;
+            }
+            l_condition.notify_all();
+          }
+      }
+    catch(...)
+      {
+        {
+          std::lock_guard<std::mutex> l_lock(l_mutex);
+          l_stop = true;
+        }
+        l_condition.notify_all();
+        l_reader.join();
+        throw;
+      }
+    l_reader.join();
+    if(l_read_exception)
+      {
+        std::rethrow_exception(l_read_exception);
+      }
+    return l_nb_point;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  template <typename SHAPE,typename SINK>
+  uint64_t point_stream<T>::classify(const SHAPE & p_shape,SINK p_sink,bool p_consider_line)
+  {
+    std::vector<bool> l_result;
+    return for_each_chunk([&](const point<T> * p_points,uint32_t p_nb_point)
+                          {
+                            p_shape.contains(p_points,p_nb_point,l_result,p_consider_line);
+                            p_sink(p_points,p_nb_point,l_result);
+                          });
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t point_stream<T>::read_chunk(std::vector<point<T>> & p_points)
+  {
+    p_points.clear();
+    if(m_error)
+      {
+        return 0;
+      }
+    p_points.reserve(m_chunk_size);
+    return t_format::BINARY == m_format ? read_binary(p_points) : read_csv(p_points);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  size_t point_stream<T>::fill(size_t p_size)
+  {
+    if(m_input_end - m_position >= p_size || m_end)
+      {
+        return m_input_end - m_position;
+      }
+    // Move remaining bytes to buffer start then read until request is met
+    std::memmove(m_input.data(),m_input.data() + m_position,m_input_end - m_position);
+    m_input_end -= m_position;
+    m_position = 0;
+    while(m_input_end < p_size && !m_end)
+      {
+        ssize_t l_nb_read = read(m_fd,m_input.data() + m_input_end,m_input.size() - m_input_end);
+        if(l_nb_read > 0)
+          {
+            m_input_end += l_nb_read;
+          }
+        else if(!l_nb_read)
+          {
+            m_end = true;
+          }
+        else if(EINTR != errno)
+          {
+            m_error = true;
+            m_end = true;
+          }
+      }
+    return m_input_end;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t point_stream<T>::read_binary(std::vector<point<T>> & p_points)
+  {
+    const size_t l_point_size = 2 * sizeof(T);
+    size_t l_available = fill(m_chunk_size * l_point_size);
+    const char * l_input = m_data ? m_data : m_input.data();
+    uint32_t l_nb_point = std::min((size_t)m_chunk_size,l_available / l_point_size);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        T l_coordinates[2];
+        std::memcpy(l_coordinates,l_input + m_position,l_point_size);
+        p_points.push_back(point<T>(l_coordinates[0],l_coordinates[1]));
+        m_position += l_point_size;
+      }
+    if(!l_nb_point && l_available)
+      {
+        m_error = true;
+      }
+    return l_nb_point;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t point_stream<T>::read_csv(std::vector<point<T>> & p_points)
+  {
+    while(p_points.size() < m_chunk_size)
+      {
+        size_t l_available = fill(m_max_line_size);
+        if(!l_available)
+          {
+            break;
+          }
+        const char * l_begin = (m_data ? m_data : m_input.data()) + m_position;
+        const char * l_end = static_cast<const char *>(std::memchr(l_begin,'\n',std::min(l_available,(size_t)m_max_line_size)));
+        if(!l_end)
+          {
+            // Last line may have no end of line
+            if(l_available >= m_max_line_size)
+              {
+                m_error = true;
+                break;
+              }
+            l_end = l_begin + l_available;
+          }
+        m_position += l_end - l_begin + (l_end - l_begin < (ptrdiff_t)l_available);
+        T l_x;
+        T l_y;
+        bool l_empty;
+        if(parse_line(l_begin,l_end,l_x,l_y,l_empty))
+          {
+            p_points.push_back(point<T>(l_x,l_y));
+          }
+        else if(!l_empty)
+          {
+            m_error = true;
+            break;
+          }
+      }
+    return p_points.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool point_stream<T>::parse_value(const char * & p_cursor,T & p_value)
+  {
+    // Values out of T range, nan and infinity are rejected rather than
+    // silently converted
+    char * l_end;
+    bool l_valid;
+    errno = 0;
+    if(std::is_integral<T>::value && std::is_signed<T>::value)
+      {
+        long long l_value = std::strtoll(p_cursor,&l_end,10);
+        l_valid = errno != ERANGE && l_value >= (long long)std::numeric_limits<T>::min() && l_value <= (long long)std::numeric_limits<T>::max();
+        p_value = (T)l_value;
+      }
+    else if(std::is_integral<T>::value)
+      {
+        // strtoull accepts negative numbers by wrapping them
+        const char * l_sign = p_cursor;
+        while(std::isspace((unsigned char)*l_sign))
+          {
+            ++l_sign;
+          }
+        unsigned long long l_value = std::strtoull(p_cursor,&l_end,10);
+        l_valid = '-' != *l_sign && errno != ERANGE && l_value <= (unsigned long long)std::numeric_limits<T>::max();
+        p_value = (T)l_value;
+      }
+    else
+      {
+        double l_value = std::strtod(p_cursor,&l_end);
+        l_valid = std::isfinite(l_value) && std::fabs(l_value) <= (double)std::numeric_limits<T>::max();
+        p_value = l_valid ? (T)l_value : T();
+      }
+    bool l_parsed = l_end != p_cursor && l_valid;
+    p_cursor = l_end;
+    return l_parsed;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool point_stream<T>::parse_line(const char * p_begin,const char * p_end,T & p_x,T & p_y,bool & p_empty)
+  {
+    // Line is copied to be null terminated for strto* functions
+    char l_line[m_max_line_size + 1];
+    size_t l_size = p_end - p_begin;
+    std::memcpy(l_line,p_begin,l_size);
+    l_line[l_size] = '\0';
+    auto l_skip = [](const char * & p_cursor,const char * p_separators)
+      {
+        while(*p_cursor && std::strchr(p_separators,*p_cursor))
+          {
+            ++p_cursor;
+          }
+      };
+    const char * l_cursor = l_line;
+    l_skip(l_cursor," \t\r");
+    p_empty = !*l_cursor;
+    if(p_empty)
+      {
+        return false;
+      }
+    bool l_parsed = parse_value(l_cursor,p_x);
+    l_skip(l_cursor," \t,;");
+    l_parsed = l_parsed && parse_value(l_cursor,p_y);
+    l_skip(l_cursor," \t\r");
+    return l_parsed && !*l_cursor;
+  }
+}
+#endif // _POINT_STREAM_HPP_
+//EOF
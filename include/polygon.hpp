@@ -22,10 +22,13 @@
 #include "segment.hpp"
 #include "shape.hpp"
 #include "convex_shape.hpp"
+#include "geometry_stats.hpp"
 #include <vector>
-#include <set>
+#include <algorithm>
+#include <utility>
 #include <stdint.h>
 #include <iostream>
+#include <mutex>
 
 namespace geometry
 {
@@ -34,86 +37,68 @@ namespace geometry
   {
   public:
     inline polygon(const std::vector<point<T>> & p_points);
+    // Bulk constructors : points are moved in storage allocated once
+    inline polygon(std::vector<point<T>> && p_points);
+    template <typename ITERATOR>
+    inline polygon(ITERATOR p_begin,ITERATOR p_end);
+    // Preparation is lazy : convex wrapping shape and outside polygons are
+    // computed once by the first call needing them, whatever the thread, and
+    // cached. Further calls only read them
     inline bool is_convex(void);
     inline void cut_in_convex_polygon(void);
+    // Eager preparation, to be called at startup to avoid first query latency
+    inline void prepare(void)const;
+    // Const queries can be run concurrently from several threads
     inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    // Batch containment tests : p_result[i] is set to the result of contains
+    // for the i-th point. Preparation is checked once for the whole batch
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    inline void contains(const T * p_x,const T * p_y,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
     inline const convex_shape<T> & get_convex_shape(void)const;
+    // Polygons cut from convex wrapping shape by cut_in_convex_polygon
+    inline uint32_t get_nb_outside_polygon(void)const;
+    inline const polygon<T> & get_outside_polygon(uint32_t p_index)const;
     inline ~polygon(void);
   private:
-    std::set<point<T>> m_convex_wrapping_points;
-    convex_shape<T> * m_convex_shape;
-    std::vector<polygon<T>*> m_outside_polygons;
+    inline void build_convex_shape(void)const;
+    inline void build_outside_polygons(void)const;
+    inline bool contains_prepared(const point<T> & p,bool p_consider_line)const;
+    // Indicate for each point if it belongs to convex wrapping shape
+    mutable std::vector<bool> m_convex_wrapping_points;
+    mutable convex_shape<T> * m_convex_shape;
+    mutable bool m_convex;
+    mutable std::vector<polygon<T>*> m_outside_polygons;
+    mutable std::once_flag m_convex_flag;
+    mutable std::once_flag m_outside_flag;
   };
 
   //------------------------------------------------------------------------------
   template <typename T> 
   inline polygon<T>::polygon(const std::vector<point<T>> & p_points):
-    m_convex_shape(nullptr)
+    polygon(std::vector<point<T>>(p_points))
   {
-    assert(p_points.size()>=3);
-#ifdef DEBUG
-    std::vector<point<T>>::const_iterator l_iter_point = p_points.begin();
-    std::vector<point<T>>::const_iterator l_iter_point_end = p_points.end();
-    std::cout << "List of point : " << std::endl ;
-    while(l_iter_point != l_iter_point_end)
-      {
-	std::cout << "(" << l_iter_point->get_x() << "," << l_iter_point->get_y() << ")" << std::endl ;
-	++l_iter_point;
-      }
-#endif
-
-    // Search for "minimum point"
-    point<T> l_min = p_points[0];
-    uint32_t l_min_index = 0;
-    uint32_t l_index = 0;
-    for(l_index = 1; l_index < p_points.size();++l_index)
-      {
-	if(p_points[l_index] < l_min)
-	  {
-	    l_min_index = l_index;
-	    l_min = p_points[l_index];
-	  }
-      }
-    l_index = l_min_index;
-
-    // Fill point list from the minimum point and duplicate it at the end of list
-    while(this->get_nb_point() < p_points.size())
-      {
-	this->internal_add(p_points[l_index]);
-	l_index = (l_index + 1) % p_points.size();
-      }
+  }
 
-#ifdef DEBUG
-    l_iter_point = m_points.begin();
-    l_iter_point_end = m_points.end();
-    std::cout << "List of point : " << std::endl ;
-    while(l_iter_point != l_iter_point_end)
-      {
-	std::cout << "(" << l_iter_point->get_x() << "," << l_iter_point->get_y() << ")" << std::endl ;
-	++l_iter_point;
-      }
-#endif
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  template <typename ITERATOR>
+  inline polygon<T>::polygon(ITERATOR p_begin,ITERATOR p_end):
+    polygon(std::vector<point<T>>(p_begin,p_end))
+  {
+  }
 
-    // Create list of segments
-    for(l_index = 0 ; l_index < this->get_nb_point();++l_index)
-      {
-	this->internal_add(segment<T>(this->get_point(l_index),this->get_point((l_index + 1) % this->get_nb_point())));
-      }
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  inline polygon<T>::polygon(std::vector<point<T>> && p_points):
+    m_convex_shape(nullptr),
+    m_convex(false)
+  {
+    assert(p_points.size()>=3);
 
-#ifdef DEBUG
-    std::vector<segment>::const_iterator l_iter = m_segments.begin();
-    std::vector<segment>::const_iterator l_iter_end = m_segments.end();
-    std::cout << "List of segment" << std::endl ;
-    while(l_iter != l_iter_end)
-      {
-	std::cout << "(" << l_iter->get_source().get_x() << "," ;
-	std::cout << l_iter->get_source().get_y() << ") -> " ;
-	std::cout << "(" << l_iter->get_dest().get_x() << "," ;
-	std::cout << l_iter->get_dest().get_y() << ")" << std::endl ;
-	++l_iter;
-      }
-#endif
-  
+    // Point list starts from the "minimum point"
+    std::rotate(p_points.begin(),std::min_element(p_points.begin(),p_points.end()),p_points.end());
+    this->internal_assign(std::move(p_points));
+    this->index_vertices();
   }
 
   //----------------------------------------------------------------------------
@@ -131,69 +116,141 @@ namespace geometry
   template <typename T> 
   bool polygon<T>::is_convex(void)
   {
-    m_convex_wrapping_points.clear();
+    std::call_once(m_convex_flag,&polygon<T>::build_convex_shape,this);
+    return m_convex;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  void polygon<T>::cut_in_convex_polygon(void)
+  {
+    prepare();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  void polygon<T>::prepare(void)const
+  {
+    std::call_once(m_convex_flag,&polygon<T>::build_convex_shape,this);
+    std::call_once(m_outside_flag,&polygon<T>::build_outside_polygons,this);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  void polygon<T>::build_convex_shape(void)const
+  {
+    GEOMETRY_STATS_SCOPE(IS_CONVEX);
+    uint32_t l_nb_point = this->get_nb_point();
+    m_convex_wrapping_points.assign(l_nb_point,false);
+
+    // Strict convex hull computed with Melkman algorithm as polygon is simple.
+    // Deque of hull point indexes is stored in an array, hull being the points
+    // between bottom and top, point at bottom is duplicated at top
+    auto l_side = [&](uint32_t p_origin,uint32_t p_dest,uint32_t p_index) -> typename segment<T>::t_wide
+      {
+        const point<T> & l_origin = this->get_point(p_origin);
+        const point<T> & l_dest = this->get_point(p_dest);
+        const point<T> & l_point = this->get_point(p_index);
+        return cross_product(l_dest.get_x() - l_origin.get_x(),l_dest.get_y() - l_origin.get_y(),l_point.get_x() - l_origin.get_x(),l_point.get_y() - l_origin.get_y());
+      };
+
+    // Points aligned with first point cannot start the deque
+    uint32_t l_start = 2;
+    while(l_start < l_nb_point && !l_side(0,l_start - 1,l_start))
+      {
+        ++l_start;
+      }
+    assert(l_start < l_nb_point);
+    std::vector<uint32_t> l_deque(2 * l_nb_point + 1);
+    uint32_t l_bottom = l_nb_point - 2;
+    uint32_t l_top = l_bottom + 3;
+    l_deque[l_bottom] = l_deque[l_top] = l_start;
+    if(l_side(0,l_start - 1,l_start) > 0)
+      {
+        l_deque[l_bottom + 1] = 0;
+        l_deque[l_bottom + 2] = l_start - 1;
+      }
+    else
+      {
+        l_deque[l_bottom + 1] = l_start - 1;
+        l_deque[l_bottom + 2] = 0;
+      }
+    for(uint32_t l_index = l_start + 1 ; l_index < l_nb_point ; ++l_index)
+      {
+        if(l_side(l_deque[l_bottom],l_deque[l_bottom + 1],l_index) > 0 && l_side(l_deque[l_top - 1],l_deque[l_top],l_index) > 0)
+          {
+            continue;
+          }
+        while(l_side(l_deque[l_bottom],l_deque[l_bottom + 1],l_index) <= 0)
+          {
+            ++l_bottom;
+          }
+        l_deque[--l_bottom] = l_index;
+        while(l_side(l_deque[l_top - 1],l_deque[l_top],l_index) <= 0)
+          {
+            --l_top;
+          }
+        l_deque[++l_top] = l_index;
+      }
+    std::vector<bool> l_hull(l_nb_point,false);
+    for(uint32_t l_index = l_bottom ; l_index < l_top ; ++l_index)
+      {
+        l_hull[l_deque[l_index]] = true;
+      }
+
+    // Hull vertices appear in polygon order. Wrapping points are the hull
+    // vertices and polygon points lying on hull edges
+    std::vector<uint32_t> l_next_hull(l_nb_point,0);
+    for(uint32_t l_index = l_nb_point - 1 ; l_index > 0 ; --l_index)
+      {
+        l_next_hull[l_index - 1] = l_hull[l_index] ? l_index : l_next_hull[l_index];
+      }
 
     // To store the list of points belonging to wrapping shape
     std::vector<point<T>> l_convex_wrapping;
 
     // First point is minimum so it is mandatory included in convex wrapping
     l_convex_wrapping.push_back(this->get_point(0));
-    m_convex_wrapping_points.insert(this->get_point(0));
-    unsigned int l_current_ref_index = 0;
+    m_convex_wrapping_points[0] = true;
+    uint32_t l_current_hull = 0;
 
     bool l_previous_point_convex = true;
     std::vector<bool> l_polygon_segment;
 
-    // Iteration on all points to check if its belongs to convex wrapping
-    for(unsigned int l_candidate_index = 1 ; l_candidate_index < this->get_nb_point(); ++l_candidate_index)
+    for(uint32_t l_candidate_index = 1 ; l_candidate_index < l_nb_point ; ++l_candidate_index)
       {
-	bool l_convex = true;
-#ifdef DEBUG
-	std::cout << "Candidate : " << this->get_point(l_candidate_index) << std::endl;
-	std::cout << "Reference : " << this->get_point(l_current_ref_index) << std::endl;
-#endif
-	// Create temp segment
-	segment<T> l_tmp_ref_seg(this->get_point(l_current_ref_index),this->get_point(l_candidate_index));
-	T l_orient = 0;
-	l_convex = true;
-	bool l_first = true;
-	for(unsigned int l_check_index = 0 ; l_check_index < this->get_nb_point() && l_convex ; ++l_check_index)
-	  {
-	    if(l_check_index != l_current_ref_index && l_check_index != l_candidate_index)
-	      {
-#ifdef DEBUG
-		std::cout << "Check : " << this->get_point(l_check_index) << std::endl;
-#endif
-		l_convex = segment<T>::check_convex_continuation(l_tmp_ref_seg.vectorial_product(segment<T>(this->get_point(l_check_index),this->get_point(l_candidate_index))),l_orient,l_first);
-		l_first = false;
-	      }
-	  }
-	if(l_convex)
-	  {
-	    l_convex_wrapping.push_back(this->get_point(l_candidate_index));
-	    m_convex_wrapping_points.insert(this->get_point(l_candidate_index));
-	    l_current_ref_index = l_candidate_index;
+        bool l_convex = l_hull[l_candidate_index];
+        if(l_convex)
+          {
+            l_current_hull = l_candidate_index;
+          }
+        else if(!l_side(l_current_hull,l_next_hull[l_current_hull],l_candidate_index))
+          {
+            const point<T> & l_point = this->get_point(l_candidate_index);
+            segment<T> l_hull_segment(this->get_point(l_current_hull),this->get_point(l_next_hull[l_current_hull]));
+            l_convex = l_hull_segment.get_min_x() <= l_point.get_x() && l_point.get_x() <= l_hull_segment.get_max_x() && l_hull_segment.get_min_y() <= l_point.get_y() && l_point.get_y() <= l_hull_segment.get_max_y();
+          }
+        if(l_convex)
+          {
+            l_convex_wrapping.push_back(this->get_point(l_candidate_index));
+            m_convex_wrapping_points[l_candidate_index] = true;
             l_polygon_segment.push_back(l_previous_point_convex);
-	  }
+          }
         l_previous_point_convex = l_convex;
       }
     l_polygon_segment.push_back(l_previous_point_convex);
 
-    bool l_result = m_convex_wrapping_points.size() == this->get_nb_point();
+    m_convex = l_convex_wrapping.size() == this->get_nb_point();
     assert(l_convex_wrapping.size() >= 3);
-    m_convex_shape = new convex_shape<T>(l_convex_wrapping[0],l_convex_wrapping[1],l_convex_wrapping[2]);
-    for(unsigned int l_index = 3; l_index < l_convex_wrapping.size() ; ++l_index)
-      {
-        m_convex_shape->add(l_convex_wrapping[l_index]);
-      }
+    m_convex_shape = new convex_shape<T>(std::move(l_convex_wrapping));
     m_convex_shape->define_polygon_segments(l_polygon_segment);
-    return l_result;
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  void polygon<T>::cut_in_convex_polygon(void)
+  void polygon<T>::build_outside_polygons(void)const
   {
+    GEOMETRY_STATS_SCOPE(CUT_IN_CONVEX_POLYGON);
     // Store previous index point which belongs to convex shape.
     // This is the case by construction for index 0
     unsigned int l_previous_index = 0;
@@ -203,7 +260,7 @@ namespace geometry
       {
 	unsigned int l_real_index = l_index % this->get_nb_point();
 	// Search for point in convex wrapping shape
-	bool l_convex_point = m_convex_wrapping_points.end() != m_convex_wrapping_points.find(this->get_point(l_real_index));
+	bool l_convex_point = m_convex_wrapping_points[l_real_index];
 	// If point doesnt belong to convex wrapping shape then this is the beginning of an outside polygon
 	if(!l_convex_point && !l_polygon_started)
 	  {
@@ -215,7 +272,7 @@ namespace geometry
 	    l_current_points.push_back(this->get_point(l_real_index));
 	    if(l_convex_point)
 	      {
-		m_outside_polygons.push_back(new polygon(l_current_points));
+		m_outside_polygons.push_back(new polygon(std::move(l_current_points)));
 		l_polygon_started = false;
 		// remove all current points
 		l_current_points.clear();
@@ -228,35 +285,56 @@ namespace geometry
       }
     for(auto l_iter:m_outside_polygons)
       {
-	if(!l_iter->is_convex())
-	  {
-	    l_iter->cut_in_convex_polygon();
-	  }
+	l_iter->prepare();
       }
   }
   //----------------------------------------------------------------------------
   template <typename T> 
   const convex_shape<T> & polygon<T>::get_convex_shape(void)const
   {
+    std::call_once(m_convex_flag,&polygon<T>::build_convex_shape,this);
     return *m_convex_shape;
   }
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  uint32_t polygon<T>::get_nb_outside_polygon(void)const
+  {
+    prepare();
+    return m_outside_polygons.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  const polygon<T> & polygon<T>::get_outside_polygon(uint32_t p_index)const
+  {
+    prepare();
+    assert(p_index < m_outside_polygons.size());
+    return *(m_outside_polygons[p_index]);
+  }
+
   //----------------------------------------------------------------------------
   template <typename T> 
   bool polygon<T>::contains(const point<T> & p,bool p_consider_line)const
   {
-#ifdef DEBUG
-    std::cout << "Polygon " << *this << " contains " << p << " ? consider line = " << p_consider_line << std::endl ;
-#endif
-    assert(m_convex_shape);
+    prepare();
+    return contains_prepared(p,p_consider_line);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  bool polygon<T>::contains_prepared(const point<T> & p,bool p_consider_line)const
+  {
+    GEOMETRY_STATS_SCOPE(CONTAINS);
     if(!shape<T>::contains(p))
       {
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
 	return false;
       }
     if(m_convex_shape->contains(p,p_consider_line))
       {
 	for(auto l_iter : m_outside_polygons)
   	  {
-	    if(l_iter->contains(p,!p_consider_line))
+	    if(l_iter->contains_prepared(p,!p_consider_line))
   	      {
  		return false;
  	      }
@@ -266,6 +344,33 @@ namespace geometry
     return false;
   }
 
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  void polygon<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    // Each point walks decomposition tree on its own : scanning the whole
+    // batch for each outside polygon costs more than the bounding box tests
+    // of the walk
+    prepare();
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains_prepared(p_points[l_index],p_consider_line);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  void polygon<T>::contains(const T * p_x,const T * p_y,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    prepare();
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains_prepared(point<T>(p_x[l_index],p_y[l_index]),p_consider_line);
+      }
+  }
+
 }
 #endif /* _POLYGON_HPP_ */
 //EOF
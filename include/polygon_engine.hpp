@@ -0,0 +1,139 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _POLYGON_ENGINE_HPP_
+#define _POLYGON_ENGINE_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include "crossing_polygon.hpp"
+#include <vector>
+#include <cinttypes>
+
+namespace geometry
+{
+  // Containment queries on a polygon through the engine best suited to the
+  // number of queries expected. Decomposition engine prepares polygon, whose
+  // cost is several times the one of building crossing engine edge table,
+  // but then answers queries faster as it does not test every edge spanning
+  // point y. It is selected once expected queries are as many as polygon
+  // vertices
+  template <typename T=double>
+  class polygon_engine
+  {
+  public:
+    typedef enum class engine_kind {CROSSING=0,DECOMPOSITION} t_engine_kind;
+
+    inline static t_engine_kind select(uint32_t p_nb_point,uint64_t p_expected_nb_query);
+
+    // Polygon is prepared if decomposition engine is selected. It is
+    // referenced by engine and must outlive it
+    inline polygon_engine(const polygon<T> & p_polygon,uint64_t p_expected_nb_query);
+    inline polygon_engine(const polygon<T> & p_polygon,t_engine_kind p_kind);
+    // Engine owns its crossing polygon
+    polygon_engine(const polygon_engine &)=delete;
+    polygon_engine & operator=(const polygon_engine &)=delete;
+    inline t_engine_kind get_kind(void)const;
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    inline ~polygon_engine(void);
+  private:
+    inline void prepare(void);
+
+    const polygon<T> & m_polygon;
+    t_engine_kind m_kind;
+    crossing_polygon<T> * m_crossing;
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename polygon_engine<T>::t_engine_kind polygon_engine<T>::select(uint32_t p_nb_point,uint64_t p_expected_nb_query)
+  {
+    return p_expected_nb_query < p_nb_point ? t_engine_kind::CROSSING : t_engine_kind::DECOMPOSITION;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  polygon_engine<T>::polygon_engine(const polygon<T> & p_polygon,uint64_t p_expected_nb_query):
+    m_polygon(p_polygon),
+    m_kind(select(p_polygon.get_nb_point(),p_expected_nb_query)),
+    m_crossing(nullptr)
+  {
+    prepare();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  polygon_engine<T>::polygon_engine(const polygon<T> & p_polygon,t_engine_kind p_kind):
+    m_polygon(p_polygon),
+    m_kind(p_kind),
+    m_crossing(nullptr)
+  {
+    prepare();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  polygon_engine<T>::~polygon_engine(void)
+  {
+    delete m_crossing;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_engine<T>::prepare(void)
+  {
+    if(t_engine_kind::CROSSING == m_kind)
+      {
+        m_crossing = new crossing_polygon<T>(m_polygon);
+      }
+    else
+      {
+        m_polygon.prepare();
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename polygon_engine<T>::t_engine_kind polygon_engine<T>::get_kind(void)const
+  {
+    return m_kind;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool polygon_engine<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    return m_crossing ? m_crossing->contains(p,p_consider_line) : m_polygon.contains(p,p_consider_line);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_engine<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    if(m_crossing)
+      {
+        m_crossing->contains(p_points,p_nb_point,p_result,p_consider_line);
+      }
+    else
+      {
+        m_polygon.contains(p_points,p_nb_point,p_result,p_consider_line);
+      }
+  }
+}
+#endif // _POLYGON_ENGINE_HPP_
+//EOF
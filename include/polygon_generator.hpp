@@ -0,0 +1,238 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _POLYGON_GENERATOR_HPP_
+#define _POLYGON_GENERATOR_HPP_
+
+#include "point.hpp"
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cmath>
+#include <cinttypes>
+
+namespace geometry
+{
+  // Deterministic generators of simple polygons used to benchmark the
+  // library. Vertices are given in counterclockwise order and rounded to the
+  // nearest value for integer coordinates
+  template <typename T=double>
+  class polygon_generator
+  {
+  public:
+    // Strictly convex polygon with at most p_nb_vertex vertices on a circle.
+    // Vertices made collinear or merged by rounding are removed
+    inline static std::vector<point<T>> convex(uint32_t p_nb_vertex,double p_radius);
+    // Star alternating vertices on circles of radius p_radius and p_radius / 2
+    inline static std::vector<point<T>> star(uint32_t p_nb_vertex,double p_radius);
+    // Comb made of p_nb_vertex / 4 teeth of width p_width and height p_height
+    inline static std::vector<point<T>> comb(uint32_t p_nb_vertex,double p_width,double p_height);
+    // Thick archimedean spiral of p_nb_turn turns, outer radius being
+    // p_radius. Each turn adds a level of outside polygons. Turn number is
+    // reduced if there are not enough vertices
+    inline static std::vector<point<T>> spiral(uint32_t p_nb_vertex,uint32_t p_nb_turn,double p_radius);
+    // Rectilinear square spiral whose corridors have width p_width. Each
+    // corner adds a level of outside polygons so decomposition depth grows
+    // linearly with p_nb_vertex
+    inline static std::vector<point<T>> nested(uint32_t p_nb_vertex,double p_width);
+  private:
+    inline static T to_coordinate(double p_value);
+    inline static void add(std::vector<point<T>> & p_points,double p_x,double p_y);
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  T polygon_generator<T>::to_coordinate(double p_value)
+  {
+    return std::is_integral<T>::value ? (T)std::llround(p_value) : (T)p_value;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_generator<T>::add(std::vector<point<T>> & p_points,double p_x,double p_y)
+  {
+    point<T> l_point(to_coordinate(p_x),to_coordinate(p_y));
+    if(p_points.empty() || !(p_points.back() == l_point))
+      {
+        p_points.push_back(l_point);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> polygon_generator<T>::convex(uint32_t p_nb_vertex,double p_radius)
+  {
+    std::vector<point<T>> l_points;
+    for(uint32_t l_index = 0 ; l_index < p_nb_vertex ; ++l_index)
+      {
+        double l_angle = 2 * M_PI * l_index / p_nb_vertex;
+        add(l_points,p_radius * std::cos(l_angle),p_radius * std::sin(l_angle));
+      }
+
+    // Monotone chain keeping only strictly convex vertices
+    std::sort(l_points.begin(),l_points.end());
+    l_points.erase(std::unique(l_points.begin(),l_points.end()),l_points.end());
+    if(l_points.size() < 3)
+      {
+        return l_points;
+      }
+    auto l_turn = [](const point<T> & p_origin,const point<T> & p_dest,const point<T> & p_point) -> double
+      {
+        return ((double)p_dest.get_x() - p_origin.get_x()) * ((double)p_point.get_y() - p_origin.get_y()) - ((double)p_dest.get_y() - p_origin.get_y()) * ((double)p_point.get_x() - p_origin.get_x());
+      };
+    std::vector<point<T>> l_hull;
+    for(uint32_t l_pass = 0 ; l_pass < 2 ; ++l_pass)
+      {
+        size_t l_start = l_hull.size();
+        for(auto & l_iter : l_points)
+          {
+            while(l_hull.size() >= l_start + 2 && l_turn(l_hull[l_hull.size() - 2],l_hull.back(),l_iter) <= 0)
+              {
+                l_hull.pop_back();
+              }
+            l_hull.push_back(l_iter);
+          }
+        l_hull.pop_back();
+        std::reverse(l_points.begin(),l_points.end());
+      }
+    return l_hull;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> polygon_generator<T>::star(uint32_t p_nb_vertex,double p_radius)
+  {
+    std::vector<point<T>> l_points;
+    for(uint32_t l_index = 0 ; l_index < p_nb_vertex ; ++l_index)
+      {
+        double l_angle = 2 * M_PI * l_index / p_nb_vertex;
+        double l_radius = l_index % 2 ? p_radius / 2 : p_radius;
+        add(l_points,l_radius * std::cos(l_angle),l_radius * std::sin(l_angle));
+      }
+    return l_points;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> polygon_generator<T>::comb(uint32_t p_nb_vertex,double p_width,double p_height)
+  {
+    uint32_t l_nb_teeth = std::max(p_nb_vertex / 4,(uint32_t)1);
+    std::vector<point<T>> l_points;
+    add(l_points,0,0);
+    add(l_points,(2 * l_nb_teeth - 1) * p_width,0);
+    for(uint32_t l_index = l_nb_teeth ; l_index-- > 0 ;)
+      {
+        add(l_points,(2 * l_index + 1) * p_width,p_height);
+        add(l_points,2 * l_index * p_width,p_height);
+        if(l_index)
+          {
+            add(l_points,2 * l_index * p_width,p_width);
+            add(l_points,(2 * l_index - 1) * p_width,p_width);
+          }
+      }
+    return l_points;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> polygon_generator<T>::spiral(uint32_t p_nb_vertex,uint32_t p_nb_turn,double p_radius)
+  {
+    // Outer boundary goes outward along r = p_pitch * (1 + theta / 2 PI),
+    // inner boundary comes back at half pitch
+    uint32_t l_nb_side = std::max(p_nb_vertex / 2,(uint32_t)2);
+    // At least 8 vertices per turn are needed to keep the spiral simple
+    uint32_t l_nb_turn = std::max(std::min(p_nb_turn,l_nb_side / 8),(uint32_t)1);
+    double l_pitch = p_radius / (l_nb_turn + 1);
+    double l_max_angle = 2 * M_PI * l_nb_turn;
+    std::vector<point<T>> l_points;
+    for(uint32_t l_index = 0 ; l_index < l_nb_side ; ++l_index)
+      {
+        double l_angle = l_max_angle * l_index / (l_nb_side - 1);
+        double l_radius = l_pitch * (1 + l_angle / (2 * M_PI));
+        add(l_points,l_radius * std::cos(l_angle),l_radius * std::sin(l_angle));
+      }
+    for(uint32_t l_index = l_nb_side ; l_index-- > 0 ;)
+      {
+        double l_angle = l_max_angle * l_index / (l_nb_side - 1);
+        double l_radius = l_pitch * (0.5 + l_angle / (2 * M_PI));
+        add(l_points,l_radius * std::cos(l_angle),l_radius * std::sin(l_angle));
+      }
+    return l_points;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  std::vector<point<T>> polygon_generator<T>::nested(uint32_t p_nb_vertex,double p_width)
+  {
+    // Wall of width p_width around a centerline turning left, length of
+    // centerline segments decreasing by 2 * p_width every two segments so
+    // that parallel parts of wall are separated by corridors of p_width
+    uint32_t l_nb_segment = std::max(p_nb_vertex / 2,(uint32_t)2) - 1;
+    const double l_step_x[4] = {1,0,-1,0};
+    const double l_step_y[4] = {0,1,0,-1};
+    std::vector<double> l_x(1,0);
+    std::vector<double> l_y(1,0);
+    for(uint32_t l_index = 0 ; l_index < l_nb_segment ; ++l_index)
+      {
+        double l_length = 2 * p_width * ((l_nb_segment - l_index) / 2 + 1);
+        l_x.push_back(l_x.back() + l_step_x[l_index % 4] * l_length);
+        l_y.push_back(l_y.back() + l_step_y[l_index % 4] * l_length);
+      }
+
+    // Offset of centerline vertex : sum of left normals of adjacent segments
+    auto l_offset_x = [&](uint32_t p_index) -> double
+      {
+        double l_offset = 0;
+        if(p_index < l_nb_segment)
+          {
+            l_offset -= l_step_y[p_index % 4];
+          }
+        if(p_index)
+          {
+            l_offset -= l_step_y[(p_index - 1) % 4];
+          }
+        return l_offset * p_width / 2;
+      };
+    auto l_offset_y = [&](uint32_t p_index) -> double
+      {
+        double l_offset = 0;
+        if(p_index < l_nb_segment)
+          {
+            l_offset += l_step_x[p_index % 4];
+          }
+        if(p_index)
+          {
+            l_offset += l_step_x[(p_index - 1) % 4];
+          }
+        return l_offset * p_width / 2;
+      };
+
+    // Right side forward then left side backward
+    std::vector<point<T>> l_points;
+    for(uint32_t l_index = 0 ; l_index <= l_nb_segment ; ++l_index)
+      {
+        add(l_points,l_x[l_index] - l_offset_x(l_index),l_y[l_index] - l_offset_y(l_index));
+      }
+    for(uint32_t l_index = l_nb_segment + 1 ; l_index-- > 0 ;)
+      {
+        add(l_points,l_x[l_index] + l_offset_x(l_index),l_y[l_index] + l_offset_y(l_index));
+      }
+    return l_points;
+  }
+}
+#endif // _POLYGON_GENERATOR_HPP_
+//EOF
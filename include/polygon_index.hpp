@@ -0,0 +1,443 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _POLYGON_INDEX_HPP_
+#define _POLYGON_INDEX_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include <vector>
+#include <algorithm>
+#include <cinttypes>
+#include <limits>
+#include <cmath>
+
+namespace geometry
+{
+  // Spatial index over polygon bounding boxes answering "which polygons
+  // contain this point" queries. Polygon id is its index in the vector given
+  // at construction. Exact containment test is only done on polygons whose
+  // bounding box contains the point. Polygons are not owned and must
+  // outlive index. Each one is prepared by its first contains query, unless
+  // polygon::prepare was called beforehand
+  template <typename T=double>
+  class polygon_index
+  {
+  public:
+    // RTREE is a STR packed R-tree, GRID a uniform grid better suited for
+    // evenly distributed polygons
+    typedef enum class index_kind {RTREE=0,GRID} t_index_kind;
+
+    inline polygon_index(const std::vector<const polygon<T> *> & p_polygons,
+                         t_index_kind p_kind=t_index_kind::RTREE);
+    inline uint32_t get_nb_polygon(void)const;
+    inline const polygon<T> & get_polygon(uint32_t p_id)const;
+    // Fill p_ids with ids of polygons containing point
+    inline void find(const point<T> & p,std::vector<uint32_t> & p_ids,bool p_consider_line=true)const;
+    // Batched version : p_ids[i] contains ids of polygons containing i-th point
+    inline void find(const point<T> * p_points,uint32_t p_nb_point,std::vector<std::vector<uint32_t>> & p_ids,bool p_consider_line=true)const;
+  private:
+    typedef struct
+    {
+      T m_min_x;
+      T m_max_x;
+      T m_min_y;
+      T m_max_y;
+    } t_box;
+
+    // Children of a node are nodes [m_first, m_first + m_nb) of level below,
+    // or entries [m_first, m_first + m_nb) for leaf level
+    typedef struct
+    {
+      t_box m_box;
+      uint32_t m_first;
+      uint32_t m_nb;
+    } t_node;
+
+    // Maximum number of children of a R-tree node
+    static const uint32_t m_node_capacity = 16;
+
+    inline static bool box_contains(const t_box & p_box,const point<T> & p);
+    inline static t_box box_union(const t_box & p_box1,const t_box & p_box2);
+    template <typename ITEM>
+    inline static void sort_tile_recursive(std::vector<ITEM> & p_items,
+                                           const std::vector<t_box> & p_boxes);
+    inline void build_rtree(void);
+    inline void build_grid(void);
+    inline void rtree_find(const point<T> & p,std::vector<uint32_t> & p_ids,std::vector<uint32_t> & p_stack,bool p_consider_line)const;
+    inline void grid_find(const point<T> & p,std::vector<uint32_t> & p_ids,bool p_consider_line)const;
+    inline uint32_t grid_x(const T & p_x)const;
+    inline uint32_t grid_y(const T & p_y)const;
+
+    std::vector<const polygon<T> *> m_polygons;
+    t_index_kind m_kind;
+    t_box m_box;
+
+    // R-tree : entries are polygon boxes and ids in leaf order, nodes of all
+    // levels are stored from leaves to root, leaves being the m_nb_leaf first
+    // nodes and root the last one
+    std::vector<t_box> m_entry_boxes;
+    std::vector<uint32_t> m_entry_ids;
+    std::vector<t_node> m_nodes;
+    uint32_t m_nb_leaf;
+
+    // Grid : polygon ids of cell i are m_cell_ids[m_cell_first[i]] to
+    // m_cell_ids[m_cell_first[i + 1] - 1]
+    uint32_t m_grid_width;
+    uint32_t m_grid_height;
+    double m_cell_width;
+    double m_cell_height;
+    std::vector<uint32_t> m_cell_first;
+    std::vector<uint32_t> m_cell_ids;
+  };
+
+  template <typename T>
+  const uint32_t polygon_index<T>::m_node_capacity;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  polygon_index<T>::polygon_index(const std::vector<const polygon<T> *> & p_polygons,
+                                  t_index_kind p_kind):
+    m_polygons(p_polygons),
+    m_kind(p_kind),
+    m_nb_leaf(0),
+    m_grid_width(0),
+    m_grid_height(0),
+    m_cell_width(0),
+    m_cell_height(0)
+  {
+    m_box.m_min_x = std::numeric_limits<T>::max();
+    m_box.m_max_x = std::numeric_limits<T>::lowest();
+    m_box.m_min_y = std::numeric_limits<T>::max();
+    m_box.m_max_y = std::numeric_limits<T>::lowest();
+    m_entry_boxes.reserve(m_polygons.size());
+    for(auto l_iter : m_polygons)
+      {
+        t_box l_box;
+        l_box.m_min_x = l_iter->get_min_x();
+        l_box.m_max_x = l_iter->get_max_x();
+        l_box.m_min_y = l_iter->get_min_y();
+        l_box.m_max_y = l_iter->get_max_y();
+        m_entry_boxes.push_back(l_box);
+        m_box = box_union(m_box,l_box);
+      }
+    if(t_index_kind::RTREE == m_kind)
+      {
+        build_rtree();
+      }
+    else
+      {
+        build_grid();
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t polygon_index<T>::get_nb_polygon(void)const
+  {
+    return m_polygons.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const polygon<T> & polygon_index<T>::get_polygon(uint32_t p_id)const
+  {
+    assert(p_id < m_polygons.size());
+    return *(m_polygons[p_id]);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool polygon_index<T>::box_contains(const t_box & p_box,const point<T> & p)
+  {
+    return p_box.m_min_x <= p.get_x() && p.get_x() <= p_box.m_max_x && p_box.m_min_y <= p.get_y() && p.get_y() <= p_box.m_max_y;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename polygon_index<T>::t_box polygon_index<T>::box_union(const t_box & p_box1,const t_box & p_box2)
+  {
+    t_box l_box;
+    l_box.m_min_x = std::min(p_box1.m_min_x,p_box2.m_min_x);
+    l_box.m_max_x = std::max(p_box1.m_max_x,p_box2.m_max_x);
+    l_box.m_min_y = std::min(p_box1.m_min_y,p_box2.m_min_y);
+    l_box.m_max_y = std::max(p_box1.m_max_y,p_box2.m_max_y);
+    return l_box;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  template <typename ITEM>
+  void polygon_index<T>::sort_tile_recursive(std::vector<ITEM> & p_items,
+                                             const std::vector<t_box> & p_boxes)
+  {
+    // Sort items by box center x, cut them in vertical slices then sort each
+    // slice by box center y so that consecutive groups of m_node_capacity
+    // items form compact nodes
+    auto l_center_x = [&](const ITEM & p_item) -> double { return (double)p_boxes[p_item].m_min_x + (double)p_boxes[p_item].m_max_x; };
+    auto l_center_y = [&](const ITEM & p_item) -> double { return (double)p_boxes[p_item].m_min_y + (double)p_boxes[p_item].m_max_y; };
+    std::sort(p_items.begin(),p_items.end(),[&](const ITEM & p_item1,const ITEM & p_item2) -> bool { return l_center_x(p_item1) < l_center_x(p_item2); });
+    uint32_t l_nb_node = (p_items.size() + m_node_capacity - 1) / m_node_capacity;
+    uint32_t l_nb_slice = (uint32_t)std::ceil(std::sqrt((double)l_nb_node));
+    uint32_t l_slice_size = l_nb_slice * m_node_capacity;
+    for(uint32_t l_first = 0 ; l_first < p_items.size() ; l_first += l_slice_size)
+      {
+        auto l_end = l_first + l_slice_size < p_items.size() ? p_items.begin() + l_first + l_slice_size : p_items.end();
+        std::sort(p_items.begin() + l_first,l_end,[&](const ITEM & p_item1,const ITEM & p_item2) -> bool { return l_center_y(p_item1) < l_center_y(p_item2); });
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::build_rtree(void)
+  {
+    if(m_polygons.empty())
+      {
+        return;
+      }
+    // Leaf level
+    m_entry_ids.resize(m_polygons.size());
+    for(uint32_t l_index = 0 ; l_index < m_polygons.size() ; ++l_index)
+      {
+        m_entry_ids[l_index] = l_index;
+      }
+    sort_tile_recursive(m_entry_ids,m_entry_boxes);
+    std::vector<t_box> l_sorted_boxes(m_entry_boxes.size());
+    for(uint32_t l_index = 0 ; l_index < m_entry_ids.size() ; ++l_index)
+      {
+        l_sorted_boxes[l_index] = m_entry_boxes[m_entry_ids[l_index]];
+      }
+    m_entry_boxes.swap(l_sorted_boxes);
+
+    std::vector<t_box> l_boxes = m_entry_boxes;
+    uint32_t l_level_first = 0;
+    uint32_t l_level_size = m_entry_boxes.size();
+    bool l_leaf = true;
+    do
+      {
+        // Pack current level in nodes of m_node_capacity children
+        uint32_t l_new_level_first = m_nodes.size();
+        for(uint32_t l_first = 0 ; l_first < l_level_size ; l_first += m_node_capacity)
+          {
+            t_node l_node;
+            l_node.m_first = l_first + (l_leaf ? 0 : l_level_first);
+            l_node.m_nb = std::min(m_node_capacity,l_level_size - l_first);
+            l_node.m_box = l_boxes[l_first];
+            for(uint32_t l_index = 1 ; l_index < l_node.m_nb ; ++l_index)
+              {
+                l_node.m_box = box_union(l_node.m_box,l_boxes[l_first + l_index]);
+              }
+            m_nodes.push_back(l_node);
+          }
+        l_level_first = l_new_level_first;
+        l_level_size = m_nodes.size() - l_new_level_first;
+        if(l_leaf)
+          {
+            m_nb_leaf = l_level_size;
+          }
+        l_leaf = false;
+        if(l_level_size > 1)
+          {
+            // Sort nodes of new level to pack them in upper level
+            std::vector<uint32_t> l_order(l_level_size);
+            l_boxes.resize(l_level_size);
+            for(uint32_t l_index = 0 ; l_index < l_level_size ; ++l_index)
+              {
+                l_order[l_index] = l_index;
+                l_boxes[l_index] = m_nodes[l_level_first + l_index].m_box;
+              }
+            sort_tile_recursive(l_order,l_boxes);
+            std::vector<t_node> l_sorted_nodes(l_level_size);
+            for(uint32_t l_index = 0 ; l_index < l_level_size ; ++l_index)
+              {
+                l_sorted_nodes[l_index] = m_nodes[l_level_first + l_order[l_index]];
+                l_boxes[l_index] = l_sorted_nodes[l_index].m_box;
+              }
+            std::copy(l_sorted_nodes.begin(),l_sorted_nodes.end(),m_nodes.begin() + l_level_first);
+          }
+      }
+    while(l_level_size > 1);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::build_grid(void)
+  {
+    if(m_polygons.empty())
+      {
+        return;
+      }
+    // Grid with about one polygon per cell
+    m_grid_width = m_grid_height = std::max((uint32_t)1,(uint32_t)std::sqrt((double)m_polygons.size()));
+    m_cell_width = ((double)m_box.m_max_x - (double)m_box.m_min_x) / m_grid_width;
+    m_cell_height = ((double)m_box.m_max_y - (double)m_box.m_min_y) / m_grid_height;
+
+    // Count then fill cell polygon lists
+    m_cell_first.assign(m_grid_width * m_grid_height + 1,0);
+    for(auto & l_box : m_entry_boxes)
+      {
+        for(uint32_t l_y = grid_y(l_box.m_min_y) ; l_y <= grid_y(l_box.m_max_y) ; ++l_y)
+          {
+            for(uint32_t l_x = grid_x(l_box.m_min_x) ; l_x <= grid_x(l_box.m_max_x) ; ++l_x)
+              {
+                ++m_cell_first[l_y * m_grid_width + l_x + 1];
+              }
+          }
+      }
+    for(uint32_t l_index = 1 ; l_index < m_cell_first.size() ; ++l_index)
+      {
+        m_cell_first[l_index] += m_cell_first[l_index - 1];
+      }
+    m_cell_ids.resize(m_cell_first.back());
+    std::vector<uint32_t> l_cell_fill(m_cell_first.begin(),m_cell_first.end() - 1);
+    for(uint32_t l_id = 0 ; l_id < m_entry_boxes.size() ; ++l_id)
+      {
+        const t_box & l_box = m_entry_boxes[l_id];
+        for(uint32_t l_y = grid_y(l_box.m_min_y) ; l_y <= grid_y(l_box.m_max_y) ; ++l_y)
+          {
+            for(uint32_t l_x = grid_x(l_box.m_min_x) ; l_x <= grid_x(l_box.m_max_x) ; ++l_x)
+              {
+                m_cell_ids[l_cell_fill[l_y * m_grid_width + l_x]++] = l_id;
+              }
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t polygon_index<T>::grid_x(const T & p_x)const
+  {
+    if(!(m_cell_width > 0))
+      {
+        return 0;
+      }
+    double l_x = ((double)p_x - (double)m_box.m_min_x) / m_cell_width;
+    return l_x < m_grid_width ? (uint32_t)l_x : m_grid_width - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t polygon_index<T>::grid_y(const T & p_y)const
+  {
+    if(!(m_cell_height > 0))
+      {
+        return 0;
+      }
+    double l_y = ((double)p_y - (double)m_box.m_min_y) / m_cell_height;
+    return l_y < m_grid_height ? (uint32_t)l_y : m_grid_height - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::find(const point<T> & p,std::vector<uint32_t> & p_ids,bool p_consider_line)const
+  {
+    p_ids.clear();
+    if(m_polygons.empty() || !box_contains(m_box,p))
+      {
+        return;
+      }
+    if(t_index_kind::RTREE == m_kind)
+      {
+        std::vector<uint32_t> l_stack;
+        rtree_find(p,p_ids,l_stack,p_consider_line);
+      }
+    else
+      {
+        grid_find(p,p_ids,p_consider_line);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::find(const point<T> * p_points,uint32_t p_nb_point,std::vector<std::vector<uint32_t>> & p_ids,bool p_consider_line)const
+  {
+    p_ids.resize(p_nb_point);
+    // Traversal stack is shared by all queries of the batch
+    std::vector<uint32_t> l_stack;
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        const point<T> & l_point = p_points[l_index];
+        p_ids[l_index].clear();
+        if(m_polygons.empty() || !box_contains(m_box,l_point))
+          {
+            continue;
+          }
+        if(t_index_kind::RTREE == m_kind)
+          {
+            rtree_find(l_point,p_ids[l_index],l_stack,p_consider_line);
+          }
+        else
+          {
+            grid_find(l_point,p_ids[l_index],p_consider_line);
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::rtree_find(const point<T> & p,std::vector<uint32_t> & p_ids,std::vector<uint32_t> & p_stack,bool p_consider_line)const
+  {
+    // Stack contains node indexes, level of node being deduced from index
+    p_stack.clear();
+    p_stack.push_back(m_nodes.size() - 1);
+    while(!p_stack.empty())
+      {
+        uint32_t l_node_index = p_stack.back();
+        p_stack.pop_back();
+        const t_node & l_node = m_nodes[l_node_index];
+        if(!box_contains(l_node.m_box,p))
+          {
+            continue;
+          }
+        if(l_node_index < m_nb_leaf)
+          {
+            // Leaf node : check candidate polygons
+            for(uint32_t l_index = l_node.m_first ; l_index < l_node.m_first + l_node.m_nb ; ++l_index)
+              {
+                if(box_contains(m_entry_boxes[l_index],p) && m_polygons[m_entry_ids[l_index]]->contains(p,p_consider_line))
+                  {
+                    p_ids.push_back(m_entry_ids[l_index]);
+                  }
+              }
+          }
+        else
+          {
+            for(uint32_t l_index = l_node.m_first ; l_index < l_node.m_first + l_node.m_nb ; ++l_index)
+              {
+                p_stack.push_back(l_index);
+              }
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void polygon_index<T>::grid_find(const point<T> & p,std::vector<uint32_t> & p_ids,bool p_consider_line)const
+  {
+    uint32_t l_cell = grid_y(p.get_y()) * m_grid_width + grid_x(p.get_x());
+    for(uint32_t l_index = m_cell_first[l_cell] ; l_index < m_cell_first[l_cell + 1] ; ++l_index)
+      {
+        uint32_t l_id = m_cell_ids[l_index];
+        if(box_contains(m_entry_boxes[l_id],p) && m_polygons[l_id]->contains(p,p_consider_line))
+          {
+            p_ids.push_back(l_id);
+          }
+      }
+  }
+}
+#endif // _POLYGON_INDEX_HPP_
+//EOF
@@ -0,0 +1,481 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _PREPARED_POLYGON_HPP_
+#define _PREPARED_POLYGON_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include "convex_kernel.hpp"
+#include "geometry_stats.hpp"
+#include <vector>
+#include <ostream>
+#include <cstring>
+#include <type_traits>
+#include <limits>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Compiled form of a polygon cut in convex polygons. The tree made of convex
+  // wrapping shapes and outside polygons is stored in contiguous arrays :
+  // nodes are in DFS order so that children of node i are the nodes in range
+  // [i + 1, m_end of node i), next sibling of a node being its m_end.
+  // Hull vertices, edge coefficients and polygon segment flags of all nodes
+  // are packed in shared arrays starting at node m_first_edge.
+  // These arrays can be written as a binary image made of a header followed
+  // by the arrays at offsets relative to image start. An image loaded in
+  // memory, typically by mapping its file, is queried in place without copy
+  template <typename T=double>
+  class prepared_polygon
+  {
+  public:
+    inline prepared_polygon(const polygon<T> & p_polygon);
+    // View on an image written by write_image. Image is not copied and must
+    // outlive prepared polygon. It has to be aligned on 16 bytes, which is
+    // the case of mapped files. An image failing is_valid_image sets
+    // has_error and gives a polygon containing no point
+    inline prepared_polygon(const void * p_image,size_t p_size);
+    prepared_polygon(const prepared_polygon &)=delete;
+    prepared_polygon & operator=(const prepared_polygon &)=delete;
+    // Prepared polygon is immutable : queries can be shared between threads
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    inline uint32_t get_nb_node(void)const;
+    inline uint32_t get_nb_edge(void)const;
+    inline bool has_error(void)const;
+
+    inline size_t get_image_size(void)const;
+    inline void write_image(std::ostream & p_stream)const;
+    // Check header of an image : format version, value type, endianness and
+    // array bounds, then node tree structure and node edge ranges so that
+    // queries stay in arrays. Coordinates and coefficients are trusted
+    inline static bool is_valid_image(const void * p_image,size_t p_size);
+  private:
+    typedef struct
+    {
+      T m_min_x;
+      T m_max_x;
+      T m_min_y;
+      T m_max_y;
+      uint32_t m_first_edge;
+      uint32_t m_nb_edge;
+      uint32_t m_end;
+      uint32_t m_parent;
+    } t_node;
+
+    // Version is to be increased each time image layout changes
+    static const uint32_t m_image_version = 1;
+    static const uint32_t m_image_alignment = 16;
+    static const uint32_t m_image_endianness = 0x01020304;
+
+    typedef struct
+    {
+      char m_magic[8];
+      uint32_t m_version;
+      uint32_t m_endianness;
+      uint32_t m_value_size;
+      uint32_t m_value_integral;
+      uint32_t m_node_size;
+      uint32_t m_nb_node;
+      uint64_t m_nb_vertex;
+      uint64_t m_nodes_offset;
+      uint64_t m_x_offset;
+      uint64_t m_y_offset;
+      uint64_t m_coef_x_offset;
+      uint64_t m_coef_y_offset;
+      uint64_t m_polygon_segments_offset;
+      uint64_t m_size;
+    } t_image_header;
+
+    inline static const char * get_image_magic(void);
+    inline static uint64_t align(uint64_t p_offset);
+    inline t_image_header get_image_header(void)const;
+
+    inline void add(const polygon<T> & p_polygon,uint32_t p_parent);
+    inline bool node_contains(const t_node & p_node,const point<T> & p,bool p_consider_line)const;
+
+    bool m_error;
+    // Arrays read by queries, pointing either to storage below or to image
+    uint32_t m_nb_node;
+    uint32_t m_nb_vertex;
+    const t_node * m_node_data;
+    const T * m_x_data;
+    const T * m_y_data;
+    const T * m_coef_x_data;
+    const T * m_coef_y_data;
+    const uint8_t * m_polygon_segments_data;
+
+    std::vector<t_node> m_nodes;
+    // Vertex arrays contain an additional closing vertex per node, coefficient
+    // and flag arrays are padded accordingly to share the same indexes
+    std::vector<T> m_x;
+    std::vector<T> m_y;
+    std::vector<T> m_coef_x;
+    std::vector<T> m_coef_y;
+    std::vector<uint8_t> m_polygon_segments;
+  };
+
+  template <typename T>
+  const uint32_t prepared_polygon<T>::m_image_version;
+  template <typename T>
+  const uint32_t prepared_polygon<T>::m_image_alignment;
+  template <typename T>
+  const uint32_t prepared_polygon<T>::m_image_endianness;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  prepared_polygon<T>::prepared_polygon(const polygon<T> & p_polygon):
+    m_error(false)
+  {
+    add(p_polygon,0);
+    m_nb_node = m_nodes.size();
+    m_nb_vertex = m_x.size();
+    m_node_data = m_nodes.data();
+    m_x_data = m_x.data();
+    m_y_data = m_y.data();
+    m_coef_x_data = m_coef_x.data();
+    m_coef_y_data = m_coef_y.data();
+    m_polygon_segments_data = m_polygon_segments.data();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  prepared_polygon<T>::prepared_polygon(const void * p_image,size_t p_size):
+    m_error(!is_valid_image(p_image,p_size)),
+    m_nb_node(0),
+    m_nb_vertex(0),
+    m_node_data(nullptr),
+    m_x_data(nullptr),
+    m_y_data(nullptr),
+    m_coef_x_data(nullptr),
+    m_coef_y_data(nullptr),
+    m_polygon_segments_data(nullptr)
+  {
+    if(m_error)
+      {
+        return;
+      }
+    const char * l_image = static_cast<const char *>(p_image);
+    const t_image_header * l_header = reinterpret_cast<const t_image_header *>(l_image);
+    m_nb_node = l_header->m_nb_node;
+    m_nb_vertex = l_header->m_nb_vertex;
+    m_node_data = reinterpret_cast<const t_node *>(l_image + l_header->m_nodes_offset);
+    m_x_data = reinterpret_cast<const T *>(l_image + l_header->m_x_offset);
+    m_y_data = reinterpret_cast<const T *>(l_image + l_header->m_y_offset);
+    m_coef_x_data = reinterpret_cast<const T *>(l_image + l_header->m_coef_x_offset);
+    m_coef_y_data = reinterpret_cast<const T *>(l_image + l_header->m_coef_y_offset);
+    m_polygon_segments_data = reinterpret_cast<const uint8_t *>(l_image + l_header->m_polygon_segments_offset);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const char * prepared_polygon<T>::get_image_magic(void)
+  {
+    return "GEOMPREP";
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint64_t prepared_polygon<T>::align(uint64_t p_offset)
+  {
+    return (p_offset + m_image_alignment - 1) / m_image_alignment * m_image_alignment;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename prepared_polygon<T>::t_image_header prepared_polygon<T>::get_image_header(void)const
+  {
+    t_image_header l_header;
+    memset(&l_header,0,sizeof(l_header));
+    memcpy(l_header.m_magic,get_image_magic(),sizeof(l_header.m_magic));
+    l_header.m_version = m_image_version;
+    l_header.m_endianness = m_image_endianness;
+    l_header.m_value_size = sizeof(T);
+    l_header.m_value_integral = std::is_integral<T>::value;
+    l_header.m_node_size = sizeof(t_node);
+    l_header.m_nb_node = m_nb_node;
+    l_header.m_nb_vertex = m_nb_vertex;
+    l_header.m_nodes_offset = align(sizeof(t_image_header));
+    l_header.m_x_offset = align(l_header.m_nodes_offset + m_nb_node * sizeof(t_node));
+    l_header.m_y_offset = align(l_header.m_x_offset + m_nb_vertex * sizeof(T));
+    l_header.m_coef_x_offset = align(l_header.m_y_offset + m_nb_vertex * sizeof(T));
+    l_header.m_coef_y_offset = align(l_header.m_coef_x_offset + m_nb_vertex * sizeof(T));
+    l_header.m_polygon_segments_offset = align(l_header.m_coef_y_offset + m_nb_vertex * sizeof(T));
+    l_header.m_size = align(l_header.m_polygon_segments_offset + m_nb_vertex);
+    return l_header;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  size_t prepared_polygon<T>::get_image_size(void)const
+  {
+    return get_image_header().m_size;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void prepared_polygon<T>::write_image(std::ostream & p_stream)const
+  {
+    t_image_header l_header = get_image_header();
+    const char l_padding[m_image_alignment] = {0};
+    uint64_t l_offset = 0;
+    auto l_write = [&](uint64_t p_offset,const void * p_data,uint64_t p_size)
+      {
+        p_stream.write(l_padding,p_offset - l_offset);
+        p_stream.write(static_cast<const char *>(p_data),p_size);
+        l_offset = p_offset + p_size;
+      };
+    l_write(0,&l_header,sizeof(l_header));
+    l_write(l_header.m_nodes_offset,m_node_data,m_nb_node * sizeof(t_node));
+    l_write(l_header.m_x_offset,m_x_data,m_nb_vertex * sizeof(T));
+    l_write(l_header.m_y_offset,m_y_data,m_nb_vertex * sizeof(T));
+    l_write(l_header.m_coef_x_offset,m_coef_x_data,m_nb_vertex * sizeof(T));
+    l_write(l_header.m_coef_y_offset,m_coef_y_data,m_nb_vertex * sizeof(T));
+    l_write(l_header.m_polygon_segments_offset,m_polygon_segments_data,m_nb_vertex);
+    l_write(l_header.m_size,nullptr,0);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool prepared_polygon<T>::is_valid_image(const void * p_image,size_t p_size)
+  {
+    if(!p_image || reinterpret_cast<uintptr_t>(p_image) % m_image_alignment || p_size < sizeof(t_image_header))
+      {
+        return false;
+      }
+    const t_image_header & l_header = *static_cast<const t_image_header *>(p_image);
+    if(memcmp(l_header.m_magic,get_image_magic(),sizeof(l_header.m_magic)) ||
+       m_image_version != l_header.m_version ||
+       m_image_endianness != l_header.m_endianness ||
+       sizeof(T) != l_header.m_value_size ||
+       (uint32_t)std::is_integral<T>::value != l_header.m_value_integral ||
+       sizeof(t_node) != l_header.m_node_size ||
+       !l_header.m_nb_node ||
+       l_header.m_size > p_size)
+      {
+        return false;
+      }
+    // Offsets have to be the ones computed by writer
+    uint64_t l_nb_vertex = l_header.m_nb_vertex;
+    uint64_t l_offset = align(sizeof(t_image_header));
+    if(l_offset != l_header.m_nodes_offset)
+      {
+        return false;
+      }
+    l_offset = align(l_offset + l_header.m_nb_node * sizeof(t_node));
+    const uint64_t * l_offsets[4] = {&l_header.m_x_offset,&l_header.m_y_offset,&l_header.m_coef_x_offset,&l_header.m_coef_y_offset};
+    for(auto l_iter : l_offsets)
+      {
+        if(l_offset != *l_iter)
+          {
+            return false;
+          }
+        l_offset = align(l_offset + l_nb_vertex * sizeof(T));
+      }
+    if(l_offset != l_header.m_polygon_segments_offset || align(l_offset + l_nb_vertex) != l_header.m_size || l_nb_vertex > std::numeric_limits<uint32_t>::max())
+      {
+        return false;
+      }
+
+    // Nodes are in DFS order : parent of a node is the innermost node whose
+    // range contains it. Each node has at least a triangle followed by its
+    // closing vertex
+    const t_node * l_nodes = reinterpret_cast<const t_node *>(static_cast<const char *>(p_image) + l_header.m_nodes_offset);
+    std::vector<uint32_t> l_ancestors;
+    for(uint32_t l_index = 0 ; l_index < l_header.m_nb_node ; ++l_index)
+      {
+        const t_node & l_node = l_nodes[l_index];
+        if(l_node.m_nb_edge < 3 ||
+           (uint64_t)l_node.m_first_edge + l_node.m_nb_edge + 1 > l_nb_vertex ||
+           l_node.m_end <= l_index ||
+           l_node.m_end > l_header.m_nb_node)
+          {
+            return false;
+          }
+        while(!l_ancestors.empty() && l_nodes[l_ancestors.back()].m_end <= l_index)
+          {
+            l_ancestors.pop_back();
+          }
+        if(l_ancestors.empty() != !l_index ||
+           (l_index && (l_ancestors.back() != l_node.m_parent || l_node.m_end > l_nodes[l_node.m_parent].m_end)))
+          {
+            return false;
+          }
+        l_ancestors.push_back(l_index);
+      }
+    return l_header.m_nb_node == l_nodes[0].m_end;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void prepared_polygon<T>::add(const polygon<T> & p_polygon,uint32_t p_parent)
+  {
+    const convex_shape<T> & l_shape = p_polygon.get_convex_shape();
+    uint32_t l_node_index = m_nodes.size();
+    t_node l_node;
+    l_node.m_min_x = p_polygon.get_min_x();
+    l_node.m_max_x = p_polygon.get_max_x();
+    l_node.m_min_y = p_polygon.get_min_y();
+    l_node.m_max_y = p_polygon.get_max_y();
+    l_node.m_first_edge = m_x.size();
+    l_node.m_nb_edge = l_shape.get_nb_segment();
+    l_node.m_end = 0;
+    l_node.m_parent = p_parent;
+    m_nodes.push_back(l_node);
+
+    for(uint32_t l_index = 0 ; l_index < l_shape.get_nb_segment() ; ++l_index)
+      {
+        const segment<T> & l_segment = l_shape.get_segment(l_index);
+        m_x.push_back(l_segment.get_source().get_x());
+        m_y.push_back(l_segment.get_source().get_y());
+        m_coef_x.push_back(l_segment.get_dest().get_x() - l_segment.get_source().get_x());
+        m_coef_y.push_back(l_segment.get_dest().get_y() - l_segment.get_source().get_y());
+        m_polygon_segments.push_back(l_shape.is_polygon_segment(l_index));
+      }
+    m_x.push_back(m_x[l_node.m_first_edge]);
+    m_y.push_back(m_y[l_node.m_first_edge]);
+    m_coef_x.push_back(0);
+    m_coef_y.push_back(0);
+    m_polygon_segments.push_back(false);
+
+    for(uint32_t l_index = 0 ; l_index < p_polygon.get_nb_outside_polygon() ; ++l_index)
+      {
+        add(p_polygon.get_outside_polygon(l_index),l_node_index);
+      }
+    m_nodes[l_node_index].m_end = m_nodes.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t prepared_polygon<T>::get_nb_node(void)const
+  {
+    return m_nb_node;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t prepared_polygon<T>::get_nb_edge(void)const
+  {
+    return m_nb_vertex - m_nb_node;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool prepared_polygon<T>::has_error(void)const
+  {
+    return m_error;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool prepared_polygon<T>::node_contains(const t_node & p_node,const point<T> & p,bool p_consider_line)const
+  {
+    if(p.get_x() < p_node.m_min_x || p_node.m_max_x < p.get_x() || p.get_y() < p_node.m_min_y || p_node.m_max_y < p.get_y())
+      {
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+        return false;
+      }
+    GEOMETRY_STATS_ADD(CONVEX_NODE_VISIT,1);
+    uint32_t l_edge_index = 0;
+    const T * l_x = m_x_data + p_node.m_first_edge;
+    const T * l_y = m_y_data + p_node.m_first_edge;
+    const T * l_coef_x = m_coef_x_data + p_node.m_first_edge;
+    const T * l_coef_y = m_coef_y_data + p_node.m_first_edge;
+    t_convex_location l_location = (p_node.m_nb_edge > convex_kernel<T>::wedge_threshold ?
+                                    convex_kernel<T>::wedge_locate(l_x,l_y,l_coef_x,l_coef_y,p_node.m_nb_edge,p,l_edge_index) :
+                                    convex_kernel<T>::locate(l_x,l_y,l_coef_x,l_coef_y,p_node.m_nb_edge,p,l_edge_index)
+                                    );
+    switch(l_location)
+      {
+      case t_convex_location::INSIDE:
+        return true;
+      case t_convex_location::OUTSIDE:
+        return false;
+      case t_convex_location::VERTEX:
+        return p_consider_line;
+      case t_convex_location::BORDER:
+        return p_consider_line && m_polygon_segments_data[p_node.m_first_edge + l_edge_index];
+      }
+    return false;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool prepared_polygon<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    // A node contains the point if its convex shape contains it and none of
+    // its children contains it with the opposite line consideration
+    GEOMETRY_STATS_SCOPE(CONTAINS);
+    if(m_error)
+      {
+        return false;
+      }
+    uint32_t l_node_index = 0;
+    bool l_consider_line = p_consider_line;
+    while(true)
+      {
+        const t_node & l_node = m_node_data[l_node_index];
+        bool l_inside = node_contains(l_node,p,l_consider_line);
+        if(l_inside && l_node_index + 1 < l_node.m_end)
+          {
+            // Children have to be checked
+            ++l_node_index;
+            l_consider_line = !l_consider_line;
+            continue;
+          }
+
+        // Result of current node is known : propagate it to ancestors
+        while(true)
+          {
+            if(!l_node_index)
+              {
+                return l_inside;
+              }
+            uint32_t l_parent_index = m_node_data[l_node_index].m_parent;
+            if(!l_inside)
+              {
+                uint32_t l_next_index = m_node_data[l_node_index].m_end;
+                if(l_next_index < m_node_data[l_parent_index].m_end)
+                  {
+                    // Check next sibling
+                    l_node_index = l_next_index;
+                    break;
+                  }
+              }
+            // Parent contains point if none of its children contains it
+            l_inside = !l_inside;
+            l_node_index = l_parent_index;
+            l_consider_line = !l_consider_line;
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void prepared_polygon<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains(p_points[l_index],p_consider_line);
+      }
+  }
+}
+#endif // _PREPARED_POLYGON_HPP_
+//EOF
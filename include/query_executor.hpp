@@ -0,0 +1,293 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _QUERY_EXECUTOR_HPP_
+#define _QUERY_EXECUTOR_HPP_
+
+#include "point.hpp"
+#include "prepared_polygon.hpp"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <algorithm>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Persistent thread pool running containment queries of a point batch
+  // against one shared shape. SHAPE is any class providing
+  // bool contains(const point<T> &,bool)const : polygon, convex_shape,
+  // prepared_polygon. Const queries of these classes are thread safe, lazy
+  // preparations (polygon convex cut, shape border index) being built once
+  // under std::call_once, so one instance can be shared by all workers
+  // whether it has been prepared or not. Each worker owns a contiguous range
+  // of chunks and steals chunks from the ranges of other workers once its own
+  // range is exhausted. Chunks write disjoint parts of result buffer so no
+  // lock is taken while processing a batch.
+  // If a query throws, remaining chunks are dropped and first exception is
+  // rethrown by contains once all workers are done with the batch.
+  // Executor itself is not reentrant : run one batch at a time
+  template <typename T=double,typename SHAPE=prepared_polygon<T>>
+  class query_executor
+  {
+  public:
+    // Calling thread takes part in queries so p_nb_thread - 1 threads are
+    // created
+    inline query_executor(uint32_t p_nb_thread=std::thread::hardware_concurrency());
+    inline uint32_t get_nb_thread(void)const;
+    // p_result[i] is set to 1 if shape contains i-th point, 0 otherwise
+    inline void contains(const SHAPE & p_shape,const point<T> * p_points,uint32_t p_nb_point,uint8_t * p_result,bool p_consider_line=true);
+    inline void contains(const SHAPE & p_shape,const point<T> * p_points,uint32_t p_nb_point,std::vector<uint8_t> & p_result,bool p_consider_line=true);
+    inline ~query_executor(void);
+  private:
+    // Chunk range owned by a worker, aligned on cache lines to avoid false
+    // sharing of counters between workers
+    struct alignas(64) t_range
+    {
+      std::atomic<uint32_t> m_next;
+      uint32_t m_end;
+    };
+
+    inline void work(uint32_t p_worker);
+    inline void process(uint32_t p_worker);
+    inline void run_chunk(uint32_t p_chunk);
+    inline void rethrow(void);
+
+    static const uint32_t m_chunk_size = 1024;
+
+    std::vector<std::thread> m_threads;
+    // Default allocators do not honour over-alignment before C++17 so ranges
+    // are placed in a buffer aligned by hand
+    std::unique_ptr<char[]> m_range_buffer;
+    t_range * m_ranges;
+    uint32_t m_nb_range;
+    std::mutex m_mutex;
+    std::condition_variable m_start_condition;
+    std::condition_variable m_end_condition;
+    uint64_t m_generation;
+    uint32_t m_nb_running;
+    bool m_stop;
+
+    // Current batch
+    const SHAPE * m_shape;
+    const point<T> * m_points;
+    uint32_t m_nb_point;
+    uint8_t * m_result;
+    bool m_consider_line;
+    std::exception_ptr m_exception;
+  };
+
+  template <typename T,typename SHAPE>
+  const uint32_t query_executor<T,SHAPE>::m_chunk_size;
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  query_executor<T,SHAPE>::query_executor(uint32_t p_nb_thread):
+    m_range_buffer(nullptr),
+    m_ranges(nullptr),
+    m_nb_range(std::max(p_nb_thread,(uint32_t)1)),
+    m_generation(0),
+    m_nb_running(0),
+    m_stop(false),
+    m_shape(nullptr),
+    m_points(nullptr),
+    m_nb_point(0),
+    m_result(nullptr),
+    m_consider_line(true)
+  {
+    std::size_t l_size = m_nb_range * sizeof(t_range);
+    std::size_t l_space = l_size + alignof(t_range);
+    m_range_buffer.reset(new char[l_space]);
+    void * l_buffer = m_range_buffer.get();
+    m_ranges = static_cast<t_range *>(std::align(alignof(t_range),l_size,l_buffer,l_space));
+    assert(m_ranges);
+    for(uint32_t l_index = 0 ; l_index < m_nb_range ; ++l_index)
+      {
+        new(m_ranges + l_index) t_range();
+      }
+    for(uint32_t l_index = 1 ; l_index < m_nb_range ; ++l_index)
+      {
+        m_threads.push_back(std::thread(&query_executor<T,SHAPE>::work,this,l_index));
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  query_executor<T,SHAPE>::~query_executor(void)
+  {
+    {
+      std::lock_guard<std::mutex> l_lock(m_mutex);
+      m_stop = true;
+    }
+    m_start_condition.notify_all();
+    for(auto & l_iter : m_threads)
+      {
+        l_iter.join();
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  uint32_t query_executor<T,SHAPE>::get_nb_thread(void)const
+  {
+    return m_nb_range;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::work(uint32_t p_worker)
+  {
+    uint64_t l_generation = 0;
+    while(true)
+      {
+        {
+          std::unique_lock<std::mutex> l_lock(m_mutex);
+          m_start_condition.wait(l_lock,[&]{return m_stop || m_generation != l_generation;});
+          if(m_stop)
+            {
+              return;
+            }
+          l_generation = m_generation;
+        }
+        process(p_worker);
+        {
+          std::lock_guard<std::mutex> l_lock(m_mutex);
+          if(!--m_nb_running)
+            {
+              m_end_condition.notify_one();
+            }
+        }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::process(uint32_t p_worker)
+  {
+    // Own range first then steal from next workers
+    try
+      {
+        for(uint32_t l_index = 0 ; l_index < m_nb_range ; ++l_index)
+          {
+            t_range & l_range = m_ranges[(p_worker + l_index) % m_nb_range];
+            while(l_range.m_next.load(std::memory_order_relaxed) < l_range.m_end)
+              {
+                uint32_t l_chunk = l_range.m_next.fetch_add(1,std::memory_order_relaxed);
+                if(l_chunk >= l_range.m_end)
+                  {
+                    break;
+                  }
+                run_chunk(l_chunk);
+              }
+          }
+      }
+    catch(...)
+      {
+        // Keep first exception and drain all ranges so that other workers
+        // stop after their current chunk
+        std::lock_guard<std::mutex> l_lock(m_mutex);
+        if(!m_exception)
+          {
+            m_exception = std::current_exception();
+          }
+        for(uint32_t l_index = 0 ; l_index < m_nb_range ; ++l_index)
+          {
+            m_ranges[l_index].m_next.store(m_ranges[l_index].m_end,std::memory_order_relaxed);
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::run_chunk(uint32_t p_chunk)
+  {
+    // 64 bits computation as last chunk may end at 2^32
+    uint64_t l_begin = (uint64_t)p_chunk * m_chunk_size;
+    uint64_t l_end = std::min(l_begin + m_chunk_size,(uint64_t)m_nb_point);
+    for(uint64_t l_index = l_begin ; l_index < l_end ; ++l_index)
+      {
+        m_result[l_index] = m_shape->contains(m_points[l_index],m_consider_line);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::rethrow(void)
+  {
+    if(m_exception)
+      {
+        std::exception_ptr l_exception = m_exception;
+        m_exception = nullptr;
+        std::rethrow_exception(l_exception);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::contains(const SHAPE & p_shape,const point<T> * p_points,uint32_t p_nb_point,uint8_t * p_result,bool p_consider_line)
+  {
+    assert(!p_nb_point || (p_points && p_result));
+    uint32_t l_nb_chunk = (uint32_t)(((uint64_t)p_nb_point + m_chunk_size - 1) / m_chunk_size);
+    uint32_t l_nb_range = m_nb_range;
+    for(uint32_t l_index = 0 ; l_index < l_nb_range ; ++l_index)
+      {
+        m_ranges[l_index].m_next.store((uint32_t)(((uint64_t)l_nb_chunk * l_index) / l_nb_range),std::memory_order_relaxed);
+        m_ranges[l_index].m_end = (uint32_t)(((uint64_t)l_nb_chunk * (l_index + 1)) / l_nb_range);
+      }
+    m_shape = &p_shape;
+    m_points = p_points;
+    m_nb_point = p_nb_point;
+    m_result = p_result;
+    m_consider_line = p_consider_line;
+    m_exception = nullptr;
+    if(l_nb_range == 1 || l_nb_chunk <= 1)
+      {
+        process(0);
+        rethrow();
+        return;
+      }
+
+    // Mutex publishes batch description and ranges to workers
+    {
+      std::lock_guard<std::mutex> l_lock(m_mutex);
+      m_nb_running = m_threads.size();
+      ++m_generation;
+    }
+    m_start_condition.notify_all();
+    process(0);
+    {
+      std::unique_lock<std::mutex> l_lock(m_mutex);
+      m_end_condition.wait(l_lock,[&]{return !m_nb_running;});
+    }
+    rethrow();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T,typename SHAPE>
+  void query_executor<T,SHAPE>::contains(const SHAPE & p_shape,const point<T> * p_points,uint32_t p_nb_point,std::vector<uint8_t> & p_result,bool p_consider_line)
+  {
+    p_result.resize(p_nb_point);
+    contains(p_shape,p_points,p_nb_point,p_result.data(),p_consider_line);
+  }
+}
+#endif // _QUERY_EXECUTOR_HPP_
+//EOF
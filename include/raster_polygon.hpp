@@ -0,0 +1,317 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _RASTER_POLYGON_HPP_
+#define _RASTER_POLYGON_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include "geometry_stats.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Occupancy mask of a polygon over a grid covering its bounding box. Each
+  // cell is stored on 2 bits and is either fully inside, fully outside or
+  // touched by polygon border. Query is a single lookup except in border
+  // cells where exact polygon test is done. Polygon is referenced by mask
+  // and must outlive it
+  template <typename T=double>
+  class raster_polygon
+  {
+  public:
+    typedef enum class cell_state {OUTSIDE=0,INSIDE,BOUNDARY} t_cell_state;
+
+    inline raster_polygon(const polygon<T> & p_polygon,uint32_t p_grid_width,uint32_t p_grid_height);
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    // Point must be in polygon bounding box
+    inline t_cell_state get_cell_state(const point<T> & p)const;
+    inline uint32_t get_grid_width(void)const;
+    inline uint32_t get_grid_height(void)const;
+    inline uint32_t get_nb_cell(t_cell_state p_state)const;
+    // Size in bytes of cell storage
+    inline size_t get_memory_size(void)const;
+  private:
+    // Margin in cell units added around border so that rounding cannot
+    // leave a cell touched by border unmarked
+    static constexpr double m_epsilon = 1e-6;
+
+    inline t_cell_state get_cell(uint32_t p_index)const;
+    inline void set_cell(uint32_t p_index,t_cell_state p_state);
+    inline uint32_t grid_x(const T & p_x)const;
+    inline uint32_t grid_y(const T & p_y)const;
+    inline uint32_t clamp(double p_value,uint32_t p_size)const;
+
+    const polygon<T> & m_polygon;
+    uint32_t m_grid_width;
+    uint32_t m_grid_height;
+    double m_cell_width;
+    double m_cell_height;
+    uint32_t m_nb_cell[3];
+    // 4 cells per byte
+    std::vector<uint8_t> m_cells;
+  };
+
+  template <typename T>
+  constexpr double raster_polygon<T>::m_epsilon;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  raster_polygon<T>::raster_polygon(const polygon<T> & p_polygon,uint32_t p_grid_width,uint32_t p_grid_height):
+    m_polygon(p_polygon),
+    m_grid_width(p_grid_width),
+    m_grid_height(p_grid_height),
+    m_cell_width(((double)p_polygon.get_max_x() - (double)p_polygon.get_min_x()) / p_grid_width),
+    m_cell_height(((double)p_polygon.get_max_y() - (double)p_polygon.get_min_y()) / p_grid_height),
+    m_nb_cell{0,0,0},
+    m_cells((p_grid_width * p_grid_height + 3) / 4,0)
+  {
+    assert(p_grid_width && p_grid_height);
+    m_polygon.prepare();
+
+    // Vertices in cell units
+    uint32_t l_nb_point = m_polygon.get_nb_point();
+    std::vector<double> l_u(l_nb_point);
+    std::vector<double> l_v(l_nb_point);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        const point<T> & l_point = m_polygon.get_point(l_index);
+        l_u[l_index] = ((double)l_point.get_x() - (double)m_polygon.get_min_x()) / m_cell_width;
+        l_v[l_index] = ((double)l_point.get_y() - (double)m_polygon.get_min_y()) / m_cell_height;
+      }
+
+    // Mark cells touched by each edge row by row, and collect abscissas
+    // where edges cross row centers, with half open rule for vertices
+    std::vector<std::vector<double>> l_crossings(m_grid_height);
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        uint32_t l_next = (l_index + 1) % l_nb_point;
+        double l_u1 = l_u[l_index];
+        double l_v1 = l_v[l_index];
+        double l_u2 = l_u[l_next];
+        double l_v2 = l_v[l_next];
+        if(l_v2 < l_v1)
+          {
+            std::swap(l_u1,l_u2);
+            std::swap(l_v1,l_v2);
+          }
+        uint32_t l_last_row = clamp(l_v2 + m_epsilon,m_grid_height);
+        for(uint32_t l_row = clamp(l_v1 - m_epsilon,m_grid_height) ; l_row <= l_last_row ; ++l_row)
+          {
+            double l_low = std::max(l_v1,(double)l_row);
+            double l_high = std::min(l_v2,(double)l_row + 1);
+            double l_min_u = std::min(l_u1,l_u2);
+            double l_max_u = std::max(l_u1,l_u2);
+            if(l_v1 < l_v2)
+              {
+                double l_slope = (l_u2 - l_u1) / (l_v2 - l_v1);
+                double l_low_u = l_u1 + (std::min(l_low,l_v2) - l_v1) * l_slope;
+                double l_high_u = l_u1 + (std::max(l_high,l_v1) - l_v1) * l_slope;
+                l_min_u = std::max(l_min_u,std::min(l_low_u,l_high_u));
+                l_max_u = std::min(l_max_u,std::max(l_low_u,l_high_u));
+
+                double l_center = l_row + 0.5;
+                if(l_v1 <= l_center && l_center < l_v2)
+                  {
+                    l_crossings[l_row].push_back(l_u1 + (l_center - l_v1) * l_slope);
+                  }
+              }
+            uint32_t l_last_column = clamp(l_max_u + m_epsilon,m_grid_width);
+            for(uint32_t l_column = clamp(l_min_u - m_epsilon,m_grid_width) ; l_column <= l_last_column ; ++l_column)
+              {
+                set_cell(l_row * m_grid_width + l_column,t_cell_state::BOUNDARY);
+              }
+          }
+      }
+
+    // Scanline fill : cells not touched by border are entirely on the side
+    // of their center, which is inside between odd and even crossings
+    for(uint32_t l_row = 0 ; l_row < m_grid_height ; ++l_row)
+      {
+        std::vector<double> & l_row_crossings = l_crossings[l_row];
+        std::sort(l_row_crossings.begin(),l_row_crossings.end());
+        for(uint32_t l_index = 0 ; l_index + 1 < l_row_crossings.size() ; l_index += 2)
+          {
+            double l_first = std::ceil(l_row_crossings[l_index] - 0.5);
+            uint32_t l_column = l_first > 0 ? (uint32_t)l_first : 0;
+            for( ; l_column < m_grid_width && l_column + 0.5 < l_row_crossings[l_index + 1] ; ++l_column)
+              {
+                uint32_t l_cell = l_row * m_grid_width + l_column;
+                if(t_cell_state::OUTSIDE == get_cell(l_cell))
+                  {
+                    set_cell(l_cell,t_cell_state::INSIDE);
+                  }
+              }
+          }
+        std::vector<double>().swap(l_row_crossings);
+      }
+
+    for(uint32_t l_cell = 0 ; l_cell < m_grid_width * m_grid_height ; ++l_cell)
+      {
+        ++m_nb_cell[(uint32_t)get_cell(l_cell)];
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename raster_polygon<T>::t_cell_state raster_polygon<T>::get_cell(uint32_t p_index)const
+  {
+    return (t_cell_state)((m_cells[p_index / 4] >> (2 * (p_index % 4))) & 0x3);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void raster_polygon<T>::set_cell(uint32_t p_index,t_cell_state p_state)
+  {
+    uint8_t & l_byte = m_cells[p_index / 4];
+    uint32_t l_shift = 2 * (p_index % 4);
+    l_byte = (l_byte & ~(0x3 << l_shift)) | ((uint32_t)p_state << l_shift);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::clamp(double p_value,uint32_t p_size)const
+  {
+    if(!(p_value > 0))
+      {
+        return 0;
+      }
+    return p_value < p_size ? (uint32_t)p_value : p_size - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::grid_x(const T & p_x)const
+  {
+    return clamp(((double)p_x - (double)m_polygon.get_min_x()) / m_cell_width,m_grid_width);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::grid_y(const T & p_y)const
+  {
+    return clamp(((double)p_y - (double)m_polygon.get_min_y()) / m_cell_height,m_grid_height);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename raster_polygon<T>::t_cell_state raster_polygon<T>::get_cell_state(const point<T> & p)const
+  {
+    return get_cell(grid_y(p.get_y()) * m_grid_width + grid_x(p.get_x()));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool raster_polygon<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    // Queries answered without polygon are counted here, the other ones by
+    // polygon
+    if(p.get_x() < m_polygon.get_min_x() || m_polygon.get_max_x() < p.get_x() || p.get_y() < m_polygon.get_min_y() || m_polygon.get_max_y() < p.get_y())
+      {
+        GEOMETRY_STATS_ADD(QUERY,1);
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+        return false;
+      }
+    switch(get_cell_state(p))
+      {
+      case t_cell_state::INSIDE:
+        GEOMETRY_STATS_ADD(QUERY,1);
+        return true;
+      case t_cell_state::OUTSIDE:
+        GEOMETRY_STATS_ADD(QUERY,1);
+        return false;
+      default:
+        return m_polygon.contains(p,p_consider_line);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void raster_polygon<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    p_result.assign(p_nb_point,false);
+
+    // Points in border cells are checked together by polygon batch test
+    std::vector<uint32_t> l_indexes;
+    std::vector<point<T>> l_points;
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        const point<T> & l_point = p_points[l_index];
+        if(l_point.get_x() < m_polygon.get_min_x() || m_polygon.get_max_x() < l_point.get_x() || l_point.get_y() < m_polygon.get_min_y() || m_polygon.get_max_y() < l_point.get_y())
+          {
+            GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+            continue;
+          }
+        t_cell_state l_state = get_cell_state(l_point);
+        if(t_cell_state::INSIDE == l_state)
+          {
+            p_result[l_index] = true;
+          }
+        else if(t_cell_state::BOUNDARY == l_state)
+          {
+            l_indexes.push_back(l_index);
+            l_points.push_back(l_point);
+          }
+      }
+    // Points given to polygon are counted as queries by it
+    GEOMETRY_STATS_ADD(QUERY,p_nb_point - l_points.size());
+    if(l_points.size())
+      {
+        std::vector<bool> l_result;
+        m_polygon.contains(l_points.data(),l_points.size(),l_result,p_consider_line);
+        for(uint32_t l_index = 0 ; l_index < l_indexes.size() ; ++l_index)
+          {
+            p_result[l_indexes[l_index]] = l_result[l_index];
+          }
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::get_grid_width(void)const
+  {
+    return m_grid_width;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::get_grid_height(void)const
+  {
+    return m_grid_height;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t raster_polygon<T>::get_nb_cell(t_cell_state p_state)const
+  {
+    return m_nb_cell[(uint32_t)p_state];
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  size_t raster_polygon<T>::get_memory_size(void)const
+  {
+    return m_cells.size() * sizeof(uint8_t);
+  }
+}
+#endif // _RASTER_POLYGON_HPP_
+//EOF
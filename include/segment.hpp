@@ -19,6 +19,8 @@
 #define _SEGMENT_HPP_
 
 #include "point.hpp"
+#include "arithmetic_traits.hpp"
+#include <type_traits>
 #include "assert.h"
 
 namespace geometry
@@ -34,6 +36,10 @@ namespace geometry
   {
     friend  std::ostream & operator<< <>(std::ostream & p_stream, const segment<T> & p_segment);
   public:
+    // Type of products of coordinates : wider than T for integers so that
+    // orientation tests do not overflow
+    typedef typename arithmetic_traits<T>::t_wide t_wide;
+
     inline segment(const T & p_source_x,const T & p_source_y,const T & p_dest_x,const T & p_dest_y);
     inline segment(const point<T> & p_source, const point<T> & dest);
     inline const point<T> & get_source(void)const;
@@ -43,32 +49,36 @@ namespace geometry
     inline T get_x(const T & p_y)const;
     inline T get_y(const T & p_x)const;
     inline bool belong(const point<T> & p_point)const;
-    inline T get_side(const point<T> & p_point)const;
-    inline T vectorial_product(const segment<T> & p_seg)const;
-    inline T scalar_product(const segment<T> & p_seg)const;
-    inline T get_square_size(void)const;
+    inline t_wide get_side(const point<T> & p_point)const;
+    inline t_wide vectorial_product(const segment<T> & p_seg)const;
+    inline t_wide scalar_product(const segment<T> & p_seg)const;
+    inline t_wide get_square_size(void)const;
     inline const T & get_min_x(void)const;
     inline const T & get_max_x(void)const;
     inline const T & get_min_y(void)const;
     inline const T & get_max_y(void)const;
     inline bool intersec(const segment<T> & p_seg)const;
     inline bool intersec(const segment<T> & p_seg,bool & p_single_point,point<T> & p_intersec)const;
-    inline static bool check_convex_continuation(const T & p_vec_prod,T & p_orient, bool p_init);
+    inline static bool check_convex_continuation(const t_wide & p_vec_prod,t_wide & p_orient, bool p_init);
 
     inline bool operator<(const segment<T> & p_seg)const;
   private:
+    // Extremities of both segments are on both sides of the other segment line
+    inline bool strictly_cross(const segment<T> & p_seg)const;
+    // Intersection point of non parallel segments, truncated for integers
+    inline point<T> get_intersection(const segment<T> & p_seg)const;
+    // p_source + p_coef * p_num / p_den truncated towards zero. First version
+    // uses a type wider than t_wide, second one a quotient/remainder
+    // decomposition staying in t_wide when no wider type exists
+    inline static T get_coordinate(const T & p_source,const T & p_coef,t_wide p_num,t_wide p_den,std::true_type);
+    inline static T get_coordinate(const T & p_source,const T & p_coef,t_wide p_num,t_wide p_den,std::false_type);
+
     typedef enum class segment_orient {OTHER=0,HORIZONTAL,VERTICAL} t_segment_orient;
     point<T> m_source;
     point<T> m_dest;
     T m_coef_x;
     T m_coef_y;
     t_segment_orient m_orient;
-    bool m_horizontal;
-    bool m_vertical;
-    T m_min_x;
-    T m_max_x;
-    T m_min_y;
-    T m_max_y;
   };
   //----------------------------------------------------------------------------
   template <typename T> 
@@ -85,13 +95,7 @@ namespace geometry
     m_dest(p_dest),
     m_coef_x(p_dest.get_x() - p_source.get_x()),
     m_coef_y(p_dest.get_y() - p_source.get_y()),
-    m_orient(m_coef_x==0 ? t_segment_orient::VERTICAL : ( m_coef_y==0 ? t_segment_orient::HORIZONTAL : t_segment_orient::OTHER)),
-    m_horizontal(m_coef_y==0),
-    m_vertical(m_coef_x==0),
-    m_min_x( p_source.get_x() <= p_dest.get_x() ? p_source.get_x() : p_dest.get_x()),
-    m_max_x( p_source.get_x() >= p_dest.get_x() ? p_source.get_x() : p_dest.get_x()),
-    m_min_y( p_source.get_y() <= p_dest.get_y() ? p_source.get_y() : p_dest.get_y()),
-    m_max_y( p_source.get_y() >= p_dest.get_y() ? p_source.get_y() : p_dest.get_y())
+    m_orient(m_coef_x==0 ? t_segment_orient::VERTICAL : ( m_coef_y==0 ? t_segment_orient::HORIZONTAL : t_segment_orient::OTHER))
   {
   }
 
@@ -121,23 +125,28 @@ namespace geometry
   template <typename T> 
   bool segment<T>::is_horizontal(void)const
   {
-    return m_horizontal;
+    return !m_coef_y;
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
   bool segment<T>::is_vertical(void)const
   {
-    return m_vertical;
+    return !m_coef_x;
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
   T segment<T>::get_x(const T & p_y)const
   {
-    assert(!m_horizontal);
+    assert(!is_horizontal());
     T l_x = m_source.get_x();
-    if(!m_vertical)
+    if(std::is_integral<T>::value)
+      {
+        // Exact computation truncated toward zero as conversion from double
+        l_x = (T)((((t_wide)m_source.get_x()) * m_coef_y + ((t_wide)m_coef_x) * (p_y - m_source.get_y())) / m_coef_y);
+      }
+    else if(!is_vertical())
       {
 	double l_t = ((double)(p_y - m_source.get_y()))/((double)(m_coef_y));
 	l_x = m_coef_x * l_t + m_source.get_x();
@@ -149,9 +158,13 @@ namespace geometry
   template <typename T> 
   T segment<T>::get_y(const T & p_x)const
   {
-    assert(!m_vertical);
+    assert(!is_vertical());
     T l_y = m_source.get_y();
-    if(!m_horizontal)
+    if(std::is_integral<T>::value)
+      {
+        l_y = (T)((((t_wide)m_source.get_y()) * m_coef_x + ((t_wide)m_coef_y) * (p_x - m_source.get_x())) / m_coef_x);
+      }
+    else if(!is_horizontal())
       {
 	double l_t = ((double)(p_x - m_source.get_x()))/((double)(m_coef_x));
 	l_y = m_coef_y * l_t + m_source.get_y();
@@ -167,43 +180,43 @@ namespace geometry
       {
 	return true;
       }
-    if(!m_vertical && !m_horizontal)
+    if(!is_vertical() && !is_horizontal())
       {
-	return (! vectorial_product(segment<T>(m_source,p_point)) && m_min_x <= p_point.get_x() && p_point.get_x() <= m_max_x);
+	return (! vectorial_product(segment<T>(m_source,p_point)) && get_min_x() <= p_point.get_x() && p_point.get_x() <= get_max_x());
       }
-    else if(m_vertical)
+    else if(is_vertical())
       {
-        return p_point.get_x() == m_min_x && m_min_y <= p_point.get_y() && p_point.get_y() <= m_max_y;
+        return p_point.get_x() == get_min_x() && get_min_y() <= p_point.get_y() && p_point.get_y() <= get_max_y();
       }
-    return p_point.get_y() == m_min_y && m_min_x <= p_point.get_x() && p_point.get_x() <= m_max_x;
+    return p_point.get_y() == get_min_y() && get_min_x() <= p_point.get_x() && p_point.get_x() <= get_max_x();
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  T segment<T>::get_side(const point<T> & p_point)const
+  typename segment<T>::t_wide segment<T>::get_side(const point<T> & p_point)const
   {
-    return m_coef_x * (p_point.get_y() - m_source.get_y()) - m_coef_y * (p_point.get_x() - m_source.get_x());
+    return cross_product(m_coef_x,m_coef_y,p_point.get_x() - m_source.get_x(),p_point.get_y() - m_source.get_y());
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  T segment<T>::vectorial_product(const segment<T> & p_seg)const
+  typename segment<T>::t_wide segment<T>::vectorial_product(const segment<T> & p_seg)const
   {
-    return m_coef_x * p_seg.m_coef_y - m_coef_y * p_seg.m_coef_x ;
+    return cross_product(m_coef_x,m_coef_y,p_seg.m_coef_x,p_seg.m_coef_y);
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  T segment<T>::scalar_product(const segment<T> & p_seg)const
+  typename segment<T>::t_wide segment<T>::scalar_product(const segment<T> & p_seg)const
   {
-    return m_coef_x * p_seg.m_coef_x + m_coef_y * p_seg.m_coef_y ;
+    return ((t_wide)m_coef_x) * p_seg.m_coef_x + ((t_wide)m_coef_y) * p_seg.m_coef_y ;
   }
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  T segment<T>::get_square_size(void)const
+  typename segment<T>::t_wide segment<T>::get_square_size(void)const
   {
-    return m_coef_x * m_coef_x+ m_coef_y * m_coef_y;
+    return ((t_wide)m_coef_x) * m_coef_x + ((t_wide)m_coef_y) * m_coef_y;
   }
 
   //----------------------------------------------------------------------------
@@ -220,12 +233,12 @@ namespace geometry
         switch(m_orient)
           {
           case t_segment_orient::OTHER:
-            if(get_x(0) == p_seg.get_x(0))
+            if(!get_side(p_seg.m_source))
               {
-                return ((p_seg.m_min_x <= m_min_x && m_min_x <= p_seg.m_max_x) || 
-                        (p_seg.m_min_x <= m_max_x && m_max_x <= p_seg.m_max_x) ||
-                        (m_min_x <= p_seg.m_max_x && p_seg.m_max_x <= m_max_x) ||
-                        (m_min_x <= p_seg.m_min_x && p_seg.m_min_x <= m_max_x)); 
+                return ((p_seg.get_min_x() <= get_min_x() && get_min_x() <= p_seg.get_max_x()) || 
+                        (p_seg.get_min_x() <= get_max_x() && get_max_x() <= p_seg.get_max_x()) ||
+                        (get_min_x() <= p_seg.get_max_x() && p_seg.get_max_x() <= get_max_x()) ||
+                        (get_min_x() <= p_seg.get_min_x() && p_seg.get_min_x() <= get_max_x())); 
               }
             else
               {
@@ -235,26 +248,26 @@ namespace geometry
           case t_segment_orient::HORIZONTAL:
             if(m_source.get_y() == p_seg.m_source.get_y())
               {
-                return ((p_seg.m_min_x <= m_min_x && m_min_x <= p_seg.m_max_x) || 
-                        (p_seg.m_min_x <= m_max_x && m_max_x <= p_seg.m_max_x) ||
-                        (m_min_x <= p_seg.m_max_x && p_seg.m_max_x <= m_max_x) ||
-                        (m_min_x <= p_seg.m_min_x && p_seg.m_min_x <= m_max_x)) ; 
+                return ((p_seg.get_min_x() <= get_min_x() && get_min_x() <= p_seg.get_max_x()) || 
+                        (p_seg.get_min_x() <= get_max_x() && get_max_x() <= p_seg.get_max_x()) ||
+                        (get_min_x() <= p_seg.get_max_x() && p_seg.get_max_x() <= get_max_x()) ||
+                        (get_min_x() <= p_seg.get_min_x() && p_seg.get_min_x() <= get_max_x())) ; 
                 break;
               }
             return false;
           case t_segment_orient::VERTICAL:
             if(m_source.get_x() == p_seg.m_source.get_x())
               {
-                return ((p_seg.m_min_y <= m_min_y && m_min_y <= p_seg.m_max_y) || 
-                        (p_seg.m_min_y <= m_max_y && m_max_y <= p_seg.m_max_y) ||
-                        (m_min_y <= p_seg.m_max_y && p_seg.m_max_y <= m_max_y) ||
-                        (m_min_y <= p_seg.m_min_y && p_seg.m_min_y <= m_max_y)) ; 
+                return ((p_seg.get_min_y() <= get_min_y() && get_min_y() <= p_seg.get_max_y()) || 
+                        (p_seg.get_min_y() <= get_max_y() && get_max_y() <= p_seg.get_max_y()) ||
+                        (get_min_y() <= p_seg.get_max_y() && p_seg.get_max_y() <= get_max_y()) ||
+                        (get_min_y() <= p_seg.get_min_y() && p_seg.get_min_y() <= get_max_y())) ; 
               }
             return false;
             break;
           }
       }
-    if(this->vectorial_product(segment<T>(m_source,p_seg.get_source())) * this->vectorial_product(segment<T>(m_source,p_seg.get_dest())) < 0 && p_seg.vectorial_product(segment<T>(p_seg.m_source,m_source)) * p_seg.vectorial_product(segment<T>(p_seg.m_source,m_dest)) < 0)
+    if(strictly_cross(p_seg))
       {
         return true;
       }
@@ -285,49 +298,22 @@ namespace geometry
           if(!this->vectorial_product(p_seg))
             {
               p_single_point = false;
-              if(get_x(0) == p_seg.get_x(0))
+              if(!get_side(p_seg.m_source))
                 {
-                  return ((p_seg.m_min_x <= m_min_x && m_min_x <= p_seg.m_max_x) || 
-                          (p_seg.m_min_x <= m_max_x && m_max_x <= p_seg.m_max_x) ||
-                          (m_min_x <= p_seg.m_max_x && p_seg.m_max_x <= m_max_x) ||
-                          (m_min_x <= p_seg.m_min_x && p_seg.m_min_x <= m_max_x)); 
+                  return ((p_seg.get_min_x() <= get_min_x() && get_min_x() <= p_seg.get_max_x()) || 
+                          (p_seg.get_min_x() <= get_max_x() && get_max_x() <= p_seg.get_max_x()) ||
+                          (get_min_x() <= p_seg.get_max_x() && p_seg.get_max_x() <= get_max_x()) ||
+                          (get_min_x() <= p_seg.get_min_x() && p_seg.get_min_x() <= get_max_x())); 
                 }
               else
                 {
                   return false;
                 }
             }
-          else if(this->vectorial_product(segment<T>(m_source,p_seg.get_source())) * this->vectorial_product(segment<T>(m_source,p_seg.get_dest())) < 0 && p_seg.vectorial_product(segment<T>(p_seg.m_source,m_source)) * p_seg.vectorial_product(segment<T>(p_seg.m_source,m_dest)) < 0)
+          else if(strictly_cross(p_seg))
             {
               p_single_point = true;
-              int l_case = 2 * (m_coef_x != p_seg.m_coef_x) + m_coef_y != p_seg.m_coef_y;
-              switch(l_case)
-                {
-                case 0:
-                  {
-                    T l_x = ((m_dest.get_x()  * p_seg.m_source.get_x() - m_source.get_x() * p_seg.m_dest.get_x()) / (m_coef_x - p_seg.m_coef_x));
-                    T l_y = ((m_dest.get_y()  * p_seg.m_source.get_y() - m_source.get_y() * p_seg.m_dest.get_y()) / (m_coef_y - p_seg.m_coef_y));
-                    p_intersec = point<T>(l_x,l_y);
-                  }
-                  break;
-                case 1:
-                  {
-                    T l_y = ((m_dest.get_y()  * p_seg.m_source.get_y() - m_source.get_y() * p_seg.m_dest.get_y()) / (m_coef_y - p_seg.m_coef_y));
-                    p_intersec = point<T>(get_x(l_y),l_y);                  
-                  }
-                  break;
-                case 2:
-                  {
-                    T l_x = ((m_dest.get_x()  * p_seg.m_source.get_x() - m_source.get_x() * p_seg.m_dest.get_x()) / (m_coef_x - p_seg.m_coef_x));
-                    p_intersec = point<T>(l_x,get_y(l_x));                  
-                  }
-                  break;
-                case 3:
-                  // Should not be possible as vectorial product is not null
-                  assert(false);
-                  break;
-                }
-              
+              p_intersec = get_intersection(p_seg);
               return true;
             }
           else
@@ -338,7 +324,7 @@ namespace geometry
         break;
       case ((int)t_segment_orient::OTHER) * 3 + ((int)t_segment_orient::HORIZONTAL):
         {
-          if(m_min_y <= p_seg.m_source.get_y() && p_seg.m_source.get_y() <= m_max_y && p_seg.m_min_x <= this->get_x(p_seg.m_source.get_y()) && this->get_x(p_seg.m_source.get_y()) << p_seg.m_max_x)
+          if(get_min_y() <= p_seg.m_source.get_y() && p_seg.m_source.get_y() <= get_max_y() && get_sign(get_side(p_seg.m_source)) * get_sign(get_side(p_seg.m_dest)) <= 0)
             {
               p_single_point = true;
               p_intersec = point<T>(this->get_x(p_seg.m_source.get_y()),p_seg.m_source.get_y());
@@ -352,11 +338,10 @@ namespace geometry
         break;
       case ((int)t_segment_orient::OTHER) * 3 + ((int)t_segment_orient::VERTICAL):
         {
-          T l_common_y = this->get_y(p_seg.m_source.get_x());
-          if(m_min_x <= p_seg.m_source.get_x() && p_seg.m_source.get_x() <= m_max_x &&  p_seg.m_min_y <= l_common_y && l_common_y  <= p_seg.m_max_y)
+          if(get_min_x() <= p_seg.m_source.get_x() && p_seg.m_source.get_x() <= get_max_x() && get_sign(get_side(p_seg.m_source)) * get_sign(get_side(p_seg.m_dest)) <= 0)
             {
               p_single_point = true;
-              p_intersec = point<T>(p_seg.m_source.get_x(),l_common_y);
+              p_intersec = point<T>(p_seg.m_source.get_x(),this->get_y(p_seg.m_source.get_x()));
               return true;
             }
           else
@@ -368,7 +353,7 @@ namespace geometry
       case ((int)t_segment_orient::HORIZONTAL) * 3 + ((int)t_segment_orient::OTHER):
       case ((int)t_segment_orient::HORIZONTAL) * 3 + ((int)t_segment_orient::VERTICAL):
         {
-          if(p_seg.get_min_y() <= m_source.get_y() && m_source.get_y() <= p_seg.get_max_y() && m_min_x <= p_seg.get_x(m_source.get_y()) && p_seg.get_x(m_source.get_y()) <= m_max_x)
+          if(p_seg.get_min_y() <= m_source.get_y() && m_source.get_y() <= p_seg.get_max_y() && get_sign(p_seg.get_side(m_source)) * get_sign(p_seg.get_side(m_dest)) <= 0)
             {
               p_single_point = true;
               p_intersec = point<T>(p_seg.get_x(m_source.get_y()),m_source.get_y());
@@ -384,23 +369,23 @@ namespace geometry
         {
           if(m_source.get_y() == p_seg.m_source.get_y())
             {
-              if(m_max_x == p_seg.m_min_x)
+              if(get_max_x() == p_seg.get_min_x())
                 {
                   p_single_point = true;
-                  p_intersec = point<T>(m_max_x,m_source.get_y());
+                  p_intersec = point<T>(get_max_x(),m_source.get_y());
                   return true;
                 }
-              if(m_min_x == p_seg.m_max_x)
+              if(get_min_x() == p_seg.get_max_x())
                 {
                   p_single_point = true;
-                  p_intersec = point<T>(m_min_x,m_source.get_y());
+                  p_intersec = point<T>(get_min_x(),m_source.get_y());
                   return true;
                 }
               p_single_point = false;
-              return (p_seg.m_min_x <= m_min_x && m_min_x <= p_seg.m_max_x) || 
-                (p_seg.m_min_x <= m_max_x && m_max_x <= p_seg.m_max_x) ||
-                (m_min_x <= p_seg.m_max_x && p_seg.m_max_x <= m_max_x) ||
-                (m_min_x <= p_seg.m_min_x && p_seg.m_min_x <= m_max_x) ; 
+              return (p_seg.get_min_x() <= get_min_x() && get_min_x() <= p_seg.get_max_x()) || 
+                (p_seg.get_min_x() <= get_max_x() && get_max_x() <= p_seg.get_max_x()) ||
+                (get_min_x() <= p_seg.get_max_x() && p_seg.get_max_x() <= get_max_x()) ||
+                (get_min_x() <= p_seg.get_min_x() && p_seg.get_min_x() <= get_max_x()) ; 
             }
           else
             {
@@ -411,7 +396,7 @@ namespace geometry
       case ((int)t_segment_orient::VERTICAL) * 3 + ((int)t_segment_orient::OTHER):
       case ((int)t_segment_orient::VERTICAL) * 3 + ((int)t_segment_orient::HORIZONTAL):
         {
-          if(p_seg.m_min_x <= m_source.get_x() && m_source.get_x() <= p_seg.m_max_x && m_min_y <= p_seg.get_y(m_source.get_x()) &&p_seg.get_y(m_source.get_x())  <= m_max_y)
+          if(p_seg.get_min_x() <= m_source.get_x() && m_source.get_x() <= p_seg.get_max_x() && get_sign(p_seg.get_side(m_source)) * get_sign(p_seg.get_side(m_dest)) <= 0)
             {
               p_single_point = true;
               p_intersec = point<T>(m_source.get_x(),p_seg.get_y(m_source.get_x()));
@@ -427,23 +412,23 @@ namespace geometry
         {
           if(m_source.get_x() == p_seg.m_source.get_x())
             {
-              if(m_max_y == p_seg.m_min_y)
+              if(get_max_y() == p_seg.get_min_y())
                 {
                   p_single_point = true;
-                  p_intersec = point<T>(m_source.get_x(),m_max_y);
+                  p_intersec = point<T>(m_source.get_x(),get_max_y());
                   return true;
                 }
-              if(m_min_y == p_seg.m_max_y)
+              if(get_min_y() == p_seg.get_max_y())
                 {
                   p_single_point = true;
-                  p_intersec = point<T>(m_source.get_x(),m_min_y);
+                  p_intersec = point<T>(m_source.get_x(),get_min_y());
                   return true;
                 }
               p_single_point = false;
-              return (p_seg.m_min_y <= m_min_y && m_min_y <= p_seg.m_max_y) || 
-                (p_seg.m_min_y <= m_max_y && m_max_y <= p_seg.m_max_y) ||
-                (m_min_y <= p_seg.m_max_y && p_seg.m_max_y <= m_max_y) ||
-                (m_min_y <= p_seg.m_min_y && p_seg.m_min_y <= m_max_y) ; 
+              return (p_seg.get_min_y() <= get_min_y() && get_min_y() <= p_seg.get_max_y()) || 
+                (p_seg.get_min_y() <= get_max_y() && get_max_y() <= p_seg.get_max_y()) ||
+                (get_min_y() <= p_seg.get_max_y() && p_seg.get_max_y() <= get_max_y()) ||
+                (get_min_y() <= p_seg.get_min_y() && p_seg.get_min_y() <= get_max_y()) ; 
             }
           else
             {
@@ -458,7 +443,110 @@ namespace geometry
 
   //----------------------------------------------------------------------------
   template <typename T> 
-  bool segment<T>::check_convex_continuation(const T & p_vec_prod,T & p_orient,bool p_init)
+  bool segment<T>::strictly_cross(const segment<T> & p_seg)const
+  {
+    return get_sign(get_side(p_seg.m_source)) * get_sign(get_side(p_seg.m_dest)) < 0 && get_sign(p_seg.get_side(m_source)) * get_sign(p_seg.get_side(m_dest)) < 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  point<T> segment<T>::get_intersection(const segment<T> & p_seg)const
+  {
+    // Intersection is m_source + t * (m_coef_x,m_coef_y) with t = l_num / l_den.
+    // Products of coordinates by l_num need twice the width of t_wide
+    typedef typename arithmetic_traits<t_wide>::t_wide t_wider;
+    typedef std::integral_constant<bool,!std::is_integral<T>::value || (sizeof(t_wider) > sizeof(t_wide))> t_has_wider;
+    t_wide l_den = vectorial_product(p_seg);
+    assert(l_den);
+    t_wide l_num = cross_product(p_seg.m_source.get_x() - m_source.get_x(),p_seg.m_source.get_y() - m_source.get_y(),p_seg.m_coef_x,p_seg.m_coef_y);
+    if(std::is_integral<T>::value)
+      {
+        return point<T>(get_coordinate(m_source.get_x(),m_coef_x,l_num,l_den,t_has_wider()),
+                        get_coordinate(m_source.get_y(),m_coef_y,l_num,l_den,t_has_wider()));
+      }
+    t_wide l_t = l_num / l_den;
+    return point<T>((T)(m_source.get_x() + m_coef_x * l_t),(T)(m_source.get_y() + m_coef_y * l_t));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  T segment<T>::get_coordinate(const T & p_source,const T & p_coef,t_wide p_num,t_wide p_den,std::true_type)
+  {
+    typedef typename arithmetic_traits<t_wide>::t_wide t_wider;
+    return (T)((((t_wider)p_source) * p_den + ((t_wider)p_coef) * p_num) / p_den);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  T segment<T>::get_coordinate(const T & p_source,const T & p_coef,t_wide p_num,t_wide p_den,std::false_type)
+  {
+    typedef typename std::make_unsigned<T>::type t_unsigned;
+    if(p_den < 0)
+      {
+        p_den = -p_den;
+        p_num = -p_num;
+      }
+    // p_num = l_quotient * p_den + l_remainder with 0 <= l_remainder < p_den
+    t_wide l_quotient = p_num / p_den;
+    t_wide l_remainder = p_num % p_den;
+    if(l_remainder < 0)
+      {
+        l_remainder += p_den;
+        --l_quotient;
+      }
+
+    // |p_coef| * l_remainder = l_high * p_den + l_low computed bit by bit.
+    // l_low and l_remainder stay below p_den so that no sum overflows
+    t_unsigned l_coef = p_coef < 0 ? -(t_unsigned)p_coef : (t_unsigned)p_coef;
+    t_wide l_high = 0;
+    t_wide l_low = 0;
+    for(int l_bit = 8 * sizeof(T) - 1 ; l_bit >= 0 ; --l_bit)
+      {
+        l_high += l_high;
+        if(l_low >= p_den - l_low)
+          {
+            l_low -= p_den - l_low;
+            ++l_high;
+          }
+        else
+          {
+            l_low += l_low;
+          }
+        if((l_coef >> l_bit) & 1)
+          {
+            if(l_low >= p_den - l_remainder)
+              {
+                l_low -= p_den - l_remainder;
+                ++l_high;
+              }
+            else
+              {
+                l_low += l_remainder;
+              }
+          }
+      }
+    if(p_coef < 0)
+      {
+        l_high = -l_high;
+        if(l_low)
+          {
+            --l_high;
+            l_low = p_den - l_low;
+          }
+      }
+
+    // Exact value is l_integer + l_low / p_den with 0 <= l_low < p_den
+    t_wide l_integer = (t_wide)p_source + (t_wide)p_coef * l_quotient + l_high;
+    if(l_integer < 0 && l_low)
+      {
+        ++l_integer;
+      }
+    return (T)l_integer;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T> 
+  bool segment<T>::check_convex_continuation(const t_wide & p_vec_prod,t_wide & p_orient,bool p_init)
   {
     bool l_convex = true;
     if(p_orient < 0)
@@ -480,28 +568,28 @@ namespace geometry
   template <typename T>
   const T & segment<T>::get_min_x(void)const
   {
-    return m_min_x;
+    return m_source.get_x() <= m_dest.get_x() ? m_source.get_x() : m_dest.get_x();
   }
   
   //----------------------------------------------------------------------------
   template <typename T>
   const T & segment<T>::get_max_x(void)const
   {
-    return m_max_x;
+    return m_source.get_x() >= m_dest.get_x() ? m_source.get_x() : m_dest.get_x();
   }
   
   //----------------------------------------------------------------------------
   template <typename T>
   const T & segment<T>::get_min_y(void)const
   {
-    return m_min_y;
+    return m_source.get_y() <= m_dest.get_y() ? m_source.get_y() : m_dest.get_y();
   }
   
   //----------------------------------------------------------------------------
   template <typename T>
   const T & segment<T>::get_max_y(void)const
   {
-    return m_max_y;
+    return m_source.get_y() >= m_dest.get_y() ? m_source.get_y() : m_dest.get_y();
   }
  
   //----------------------------------------------------------------------------
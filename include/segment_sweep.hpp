@@ -0,0 +1,494 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _SEGMENT_SWEEP_HPP_
+#define _SEGMENT_SWEEP_HPP_
+
+#include "point.hpp"
+#include "segment.hpp"
+#include "arithmetic_traits.hpp"
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Bentley-Ottmann sweep reporting all intersecting pairs of a collection of
+  // segments in O((N + K) log N). Sweep line is vertical and moves towards
+  // increasing x, events at the same x being processed by increasing y.
+  // Intersections include crossings, touching extremities, T junctions and
+  // collinear overlaps. Only sweep position is computed in double, with a
+  // tolerance relative to the magnitude of compared values : intersection
+  // tests and ordering of segments meeting on sweep line use exact
+  // orientation predicates on T
+  template <typename T=double>
+  class segment_sweep
+  {
+  public:
+    // Segments m_first < m_second intersect. m_point is their first common
+    // point met by the sweep, truncated for integers as segment<T>::intersec
+    // does when segments cross. m_single_point is false for collinear
+    // overlaps
+    typedef struct
+    {
+      uint32_t m_first;
+      uint32_t m_second;
+      bool m_single_point;
+      point<T> m_point;
+    } t_intersection;
+
+    inline segment_sweep(const std::vector<segment<T>> & p_segments);
+    inline void compute(std::vector<t_intersection> & p_intersections);
+  private:
+    // Segment with extremities ordered along the sweep. m_tolerance is
+    // relative to its coordinates magnitude
+    typedef struct
+    {
+      double m_x1;
+      double m_y1;
+      double m_x2;
+      double m_y2;
+      double m_tolerance;
+      bool m_reversed;
+    } t_sweep_segment;
+
+    typedef enum class contact {NONE=0,EXTREMITY,OVERLAP,CROSSING} t_contact;
+
+    // Segments starting and ending at an event point
+    typedef struct
+    {
+      std::vector<uint32_t> m_upper;
+      std::vector<uint32_t> m_lower;
+    } t_event;
+
+    class status_comparator
+    {
+    public:
+      inline status_comparator(const segment_sweep & p_sweep);
+      inline bool operator()(const uint32_t & p_segment1,const uint32_t & p_segment2)const;
+    private:
+      const segment_sweep & m_sweep;
+    };
+
+    typedef std::map<std::pair<double,double>,t_event> t_event_queue;
+    typedef std::set<uint32_t,status_comparator> t_status;
+
+    // Id used to search event point in status
+    static const uint32_t m_probe = std::numeric_limits<uint32_t>::max();
+
+    inline double get_key(uint32_t p_segment)const;
+    inline double get_tolerance(uint32_t p_segment)const;
+    inline static double get_tolerance(double p_x,double p_y);
+    inline bool is_tied(uint32_t p_segment1,double p_key1,uint32_t p_segment2,double p_key2)const;
+    // Sign of slope of first segment minus slope of second one
+    inline int compare_slopes(uint32_t p_segment1,uint32_t p_segment2)const;
+    inline const point<T> & get_first(uint32_t p_segment)const;
+    inline const point<T> & get_second(uint32_t p_segment)const;
+    // Exact contact between segments. p_point is the extremity touching the
+    // other segment, the start of common part or the crossing point
+    inline t_contact get_contact(uint32_t p_segment1,uint32_t p_segment2,point<T> & p_point)const;
+    inline typename t_event_queue::iterator get_event(double p_x,double p_y);
+    inline void find_new_event(uint32_t p_segment1,uint32_t p_segment2);
+    inline void report(uint32_t p_segment1,uint32_t p_segment2,std::vector<t_intersection> & p_intersections);
+
+    const std::vector<segment<T>> & m_segments;
+    std::vector<t_sweep_segment> m_sweep_segments;
+    double m_sweep_x;
+    double m_sweep_y;
+    t_event_queue m_events;
+    t_status m_status;
+    std::vector<typename t_status::iterator> m_positions;
+    std::unordered_set<uint64_t> m_reported;
+  };
+
+  template <typename T>
+  const uint32_t segment_sweep<T>::m_probe;
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  segment_sweep<T>::status_comparator::status_comparator(const segment_sweep & p_sweep):
+    m_sweep(p_sweep)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool segment_sweep<T>::status_comparator::operator()(const uint32_t & p_segment1,const uint32_t & p_segment2)const
+  {
+    if(p_segment1 == p_segment2)
+      {
+        return false;
+      }
+    double l_key1 = m_sweep.get_key(p_segment1);
+    double l_key2 = m_sweep.get_key(p_segment2);
+    if(!m_sweep.is_tied(p_segment1,l_key1,p_segment2,l_key2))
+      {
+        return l_key1 < l_key2;
+      }
+    // Event point is before segments meeting it
+    if(m_sweep.m_probe == p_segment1 || m_sweep.m_probe == p_segment2)
+      {
+        return m_sweep.m_probe == p_segment1;
+      }
+    // Segments meet on sweep line : order them as they are right after the
+    // meeting point if it has been processed, right before otherwise
+    int l_order = m_sweep.compare_slopes(p_segment1,p_segment2);
+    if(l_order)
+      {
+        bool l_processed = l_key1 <= m_sweep.m_sweep_y + std::max(m_sweep.get_tolerance(p_segment1),get_tolerance(m_sweep.m_sweep_x,m_sweep.m_sweep_y));
+        return l_processed ? l_order < 0 : l_order > 0;
+      }
+    return p_segment1 < p_segment2;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  segment_sweep<T>::segment_sweep(const std::vector<segment<T>> & p_segments):
+    m_segments(p_segments),
+    m_sweep_x(0),
+    m_sweep_y(0),
+    m_status(status_comparator(*this))
+  {
+    m_sweep_segments.reserve(m_segments.size());
+    for(auto & l_iter : m_segments)
+      {
+        t_sweep_segment l_segment;
+        l_segment.m_reversed = l_iter.get_dest() < l_iter.get_source();
+        const point<T> & l_first = l_segment.m_reversed ? l_iter.get_dest() : l_iter.get_source();
+        const point<T> & l_second = l_segment.m_reversed ? l_iter.get_source() : l_iter.get_dest();
+        l_segment.m_x1 = (double)l_first.get_x();
+        l_segment.m_y1 = (double)l_first.get_y();
+        l_segment.m_x2 = (double)l_second.get_x();
+        l_segment.m_y2 = (double)l_second.get_y();
+        l_segment.m_tolerance = std::max(get_tolerance(l_segment.m_x1,l_segment.m_y1),get_tolerance(l_segment.m_x2,l_segment.m_y2));
+        m_sweep_segments.push_back(l_segment);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double segment_sweep<T>::get_key(uint32_t p_segment)const
+  {
+    if(m_probe == p_segment)
+      {
+        return m_sweep_y;
+      }
+    const t_sweep_segment & l_segment = m_sweep_segments[p_segment];
+    if(l_segment.m_x1 == l_segment.m_x2)
+      {
+        // Vertical segment is only in status when sweep is on it
+        return std::min(std::max(m_sweep_y,l_segment.m_y1),l_segment.m_y2);
+      }
+    if(m_sweep_x <= l_segment.m_x1)
+      {
+        return l_segment.m_y1;
+      }
+    if(m_sweep_x >= l_segment.m_x2)
+      {
+        return l_segment.m_y2;
+      }
+    return l_segment.m_y1 + (m_sweep_x - l_segment.m_x1) * (l_segment.m_y2 - l_segment.m_y1) / (l_segment.m_x2 - l_segment.m_x1);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double segment_sweep<T>::get_tolerance(double p_x,double p_y)
+  {
+    return 1e-10 * std::max(1.0,std::max(std::fabs(p_x),std::fabs(p_y)));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  double segment_sweep<T>::get_tolerance(uint32_t p_segment)const
+  {
+    return m_probe == p_segment ? get_tolerance(m_sweep_x,m_sweep_y) : m_sweep_segments[p_segment].m_tolerance;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool segment_sweep<T>::is_tied(uint32_t p_segment1,double p_key1,uint32_t p_segment2,double p_key2)const
+  {
+    return std::fabs(p_key1 - p_key2) <= std::max(get_tolerance(p_segment1),get_tolerance(p_segment2));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int segment_sweep<T>::compare_slopes(uint32_t p_segment1,uint32_t p_segment2)const
+  {
+    // Directions point towards increasing x, or increasing y for vertical
+    // segments, so their vectorial product gives slope order
+    const point<T> & l_first1 = get_first(p_segment1);
+    const point<T> & l_first2 = get_first(p_segment2);
+    const point<T> & l_second1 = get_second(p_segment1);
+    const point<T> & l_second2 = get_second(p_segment2);
+    return -get_sign(cross_product(l_second1.get_x() - l_first1.get_x(),l_second1.get_y() - l_first1.get_y(),l_second2.get_x() - l_first2.get_x(),l_second2.get_y() - l_first2.get_y()));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const point<T> & segment_sweep<T>::get_first(uint32_t p_segment)const
+  {
+    return m_sweep_segments[p_segment].m_reversed ? m_segments[p_segment].get_dest() : m_segments[p_segment].get_source();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  const point<T> & segment_sweep<T>::get_second(uint32_t p_segment)const
+  {
+    return m_sweep_segments[p_segment].m_reversed ? m_segments[p_segment].get_source() : m_segments[p_segment].get_dest();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename segment_sweep<T>::t_contact segment_sweep<T>::get_contact(uint32_t p_segment1,uint32_t p_segment2,point<T> & p_point)const
+  {
+    const point<T> & l_first1 = get_first(p_segment1);
+    const point<T> & l_second1 = get_second(p_segment1);
+    const point<T> & l_first2 = get_first(p_segment2);
+    const point<T> & l_second2 = get_second(p_segment2);
+    auto l_turn = [](const point<T> & p1,const point<T> & p2,const point<T> & p3) -> int
+      {
+        return get_sign(cross_product(p2.get_x() - p1.get_x(),p2.get_y() - p1.get_y(),p3.get_x() - p1.get_x(),p3.get_y() - p1.get_y()));
+      };
+    int l_side_first2 = l_turn(l_first1,l_second1,l_first2);
+    int l_side_second2 = l_turn(l_first1,l_second1,l_second2);
+    int l_side_first1 = l_turn(l_first2,l_second2,l_first1);
+    int l_side_second1 = l_turn(l_first2,l_second2,l_second1);
+    if(!l_side_first2 && !l_side_second2 && !l_side_first1 && !l_side_second1)
+      {
+        // Aligned segments, single points included : points of a line are
+        // ordered as along the line
+        const point<T> & l_start = l_first1 < l_first2 ? l_first2 : l_first1;
+        const point<T> & l_end = l_second2 < l_second1 ? l_second2 : l_second1;
+        if(l_end < l_start)
+          {
+            return t_contact::NONE;
+          }
+        p_point = l_start;
+        return l_start == l_end ? t_contact::EXTREMITY : t_contact::OVERLAP;
+      }
+    if(l_side_first2 * l_side_second2 > 0 || l_side_first1 * l_side_second1 > 0)
+      {
+        return t_contact::NONE;
+      }
+    if(!l_side_first2 || !l_side_second2 || !l_side_first1 || !l_side_second1)
+      {
+        p_point = !l_side_first2 ? l_first2 : (!l_side_second2 ? l_second2 : (!l_side_first1 ? l_first1 : l_second1));
+        return t_contact::EXTREMITY;
+      }
+    bool l_single_point = false;
+    bool l_crossing = m_segments[p_segment1].intersec(m_segments[p_segment2],l_single_point,p_point);
+    assert(l_crossing && l_single_point);
+    (void)l_crossing;
+    return t_contact::CROSSING;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  typename segment_sweep<T>::t_event_queue::iterator segment_sweep<T>::get_event(double p_x,double p_y)
+  {
+    // Reuse an existing event closer than tolerance
+    double l_tolerance = get_tolerance(p_x,p_y);
+    for(auto l_iter = m_events.lower_bound(std::pair<double,double>(p_x - l_tolerance,std::numeric_limits<double>::lowest())) ;
+        l_iter != m_events.end() && l_iter->first.first <= p_x + l_tolerance ;
+        ++l_iter)
+      {
+        if(std::fabs(l_iter->first.second - p_y) <= l_tolerance)
+          {
+            return l_iter;
+          }
+      }
+    return m_events.insert(std::make_pair(std::pair<double,double>(p_x,p_y),t_event())).first;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void segment_sweep<T>::find_new_event(uint32_t p_segment1,uint32_t p_segment2)
+  {
+    // Collinear overlaps are reported at the event where the second segment
+    // starts
+    point<T> l_point(get_first(p_segment1));
+    t_contact l_contact = get_contact(p_segment1,p_segment2,l_point);
+    if(t_contact::NONE == l_contact || t_contact::OVERLAP == l_contact)
+      {
+        return;
+      }
+    double l_x = (double)l_point.get_x();
+    double l_y = (double)l_point.get_y();
+    if(t_contact::CROSSING == l_contact)
+      {
+        // Crossing point may be truncated : its position is computed again
+        const t_sweep_segment & l_segment1 = m_sweep_segments[p_segment1];
+        const t_sweep_segment & l_segment2 = m_sweep_segments[p_segment2];
+        double l_coef_x1 = l_segment1.m_x2 - l_segment1.m_x1;
+        double l_coef_y1 = l_segment1.m_y2 - l_segment1.m_y1;
+        double l_coef_x2 = l_segment2.m_x2 - l_segment2.m_x1;
+        double l_coef_y2 = l_segment2.m_y2 - l_segment2.m_y1;
+        double l_t = ((l_segment2.m_x1 - l_segment1.m_x1) * l_coef_y2 - (l_segment2.m_y1 - l_segment1.m_y1) * l_coef_x2) / (l_coef_x1 * l_coef_y2 - l_coef_y1 * l_coef_x2);
+        l_t = std::min(std::max(l_t,0.0),1.0);
+        l_x = l_segment1.m_x1 + l_t * l_coef_x1;
+        l_y = l_segment1.m_y1 + l_t * l_coef_y1;
+      }
+    // Only points after current event are new events
+    double l_tolerance = get_tolerance(l_x,l_y);
+    if(l_x > m_sweep_x + l_tolerance || (l_x >= m_sweep_x - l_tolerance && l_y > m_sweep_y + l_tolerance))
+      {
+        get_event(l_x,l_y);
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void segment_sweep<T>::report(uint32_t p_segment1,uint32_t p_segment2,std::vector<t_intersection> & p_intersections)
+  {
+    uint32_t l_first = std::min(p_segment1,p_segment2);
+    uint32_t l_second = std::max(p_segment1,p_segment2);
+    if(!m_reported.insert((((uint64_t)l_first) << 32) | l_second).second)
+      {
+        return;
+      }
+    point<T> l_point(get_first(l_first));
+    t_contact l_contact = get_contact(l_first,l_second,l_point);
+    if(t_contact::NONE == l_contact)
+      {
+        return;
+      }
+    t_intersection l_intersection = {l_first,l_second,t_contact::OVERLAP != l_contact,l_point};
+    p_intersections.push_back(l_intersection);
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void segment_sweep<T>::compute(std::vector<t_intersection> & p_intersections)
+  {
+    m_events.clear();
+    m_status.clear();
+    m_reported.clear();
+    m_positions.assign(m_sweep_segments.size(),m_status.end());
+    for(uint32_t l_index = 0 ; l_index < m_sweep_segments.size() ; ++l_index)
+      {
+        const t_sweep_segment & l_segment = m_sweep_segments[l_index];
+        m_events[std::pair<double,double>(l_segment.m_x1,l_segment.m_y1)].m_upper.push_back(l_index);
+        m_events[std::pair<double,double>(l_segment.m_x2,l_segment.m_y2)].m_lower.push_back(l_index);
+      }
+
+    std::vector<uint32_t> l_meeting;
+    std::vector<uint32_t> l_inserted;
+    while(!m_events.empty())
+      {
+        auto l_event_iter = m_events.begin();
+        m_sweep_x = l_event_iter->first.first;
+        m_sweep_y = l_event_iter->first.second;
+        t_event l_event;
+        std::swap(l_event,l_event_iter->second);
+        m_events.erase(l_event_iter);
+
+        // Segments of status containing event point are contiguous and start
+        // at position of point
+        l_meeting.clear();
+        for(auto l_iter = m_status.lower_bound(m_probe) ; l_iter != m_status.end() && is_tied(*l_iter,get_key(*l_iter),m_probe,m_sweep_y) ; ++l_iter)
+          {
+            l_meeting.push_back(*l_iter);
+          }
+        for(auto l_iter : l_event.m_lower)
+          {
+            if(m_positions[l_iter] != m_status.end() && std::find(l_meeting.begin(),l_meeting.end(),l_iter) == l_meeting.end())
+              {
+                l_meeting.push_back(l_iter);
+              }
+          }
+
+        // All segments containing event point intersect each other
+        std::vector<uint32_t> l_all(l_meeting);
+        l_all.insert(l_all.end(),l_event.m_upper.begin(),l_event.m_upper.end());
+        for(uint32_t l_index1 = 0 ; l_index1 < l_all.size() ; ++l_index1)
+          {
+            for(uint32_t l_index2 = l_index1 + 1 ; l_index2 < l_all.size() ; ++l_index2)
+              {
+                report(l_all[l_index1],l_all[l_index2],p_intersections);
+              }
+          }
+
+        // Remove all segments containing point then insert again the ones
+        // continuing after it so that they are ordered as after the point
+        l_inserted.clear();
+        for(auto l_iter : l_meeting)
+          {
+            m_status.erase(m_positions[l_iter]);
+            m_positions[l_iter] = m_status.end();
+            const t_sweep_segment & l_segment = m_sweep_segments[l_iter];
+            bool l_end = std::fabs(l_segment.m_x2 - m_sweep_x) <= l_segment.m_tolerance && std::fabs(l_segment.m_y2 - m_sweep_y) <= l_segment.m_tolerance;
+            if(!l_end && std::find(l_event.m_lower.begin(),l_event.m_lower.end(),l_iter) == l_event.m_lower.end())
+              {
+                l_inserted.push_back(l_iter);
+              }
+          }
+        for(auto l_iter : l_event.m_upper)
+          {
+            const t_sweep_segment & l_segment = m_sweep_segments[l_iter];
+            if(l_segment.m_x1 != l_segment.m_x2 || l_segment.m_y1 != l_segment.m_y2)
+              {
+                l_inserted.push_back(l_iter);
+              }
+          }
+        for(auto l_iter : l_inserted)
+          {
+            m_positions[l_iter] = m_status.insert(l_iter).first;
+          }
+
+        // Check new neighbours
+        auto l_lowest = m_status.lower_bound(m_probe);
+        if(l_inserted.empty())
+          {
+            if(l_lowest != m_status.end() && l_lowest != m_status.begin())
+              {
+                auto l_below = l_lowest;
+                --l_below;
+                find_new_event(*l_below,*l_lowest);
+              }
+          }
+        else
+          {
+            auto l_highest = l_lowest;
+            for(uint32_t l_index = 1 ; l_index < l_inserted.size() ; ++l_index)
+              {
+                ++l_highest;
+              }
+            if(l_lowest != m_status.begin())
+              {
+                auto l_below = l_lowest;
+                --l_below;
+                find_new_event(*l_below,*l_lowest);
+              }
+            auto l_above = l_highest;
+            ++l_above;
+            if(l_above != m_status.end())
+              {
+                find_new_event(*l_highest,*l_above);
+              }
+          }
+      }
+  }
+}
+#endif // _SEGMENT_SWEEP_HPP_
+//EOF
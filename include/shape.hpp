@@ -21,10 +21,14 @@
 
 #include "point.hpp"
 #include "segment.hpp"
+#include "arithmetic_traits.hpp"
 #include <vector>
-#include <set>
+#include <algorithm>
 #include <cinttypes>
 #include <limits>
+#include <cmath>
+#include <memory>
+#include <mutex>
 
 namespace geometry
 {
@@ -40,28 +44,81 @@ namespace geometry
     friend  std::ostream & operator<< <>(std::ostream & p_stream, const shape<T> & p_shape);
   public:
     inline shape<T>(void);
+    // Copies do not share border index, which is built again on demand
+    inline shape<T>(const shape<T> & p_shape);
+    inline shape<T> & operator=(const shape<T> & p_shape);
     inline uint32_t get_nb_point(void)const;
     inline uint32_t get_nb_segment(void)const;
-    inline const segment<T> & get_segment(const uint32_t & p_index)const;
+    // Segments are not stored but built on demand from consecutive points
+    inline segment<T> get_segment(const uint32_t & p_index)const;
     inline const point<T> & get_point(const uint32_t & p_index)const;
     inline virtual bool contains(const point<T> & p,bool p_consider_line=true)const=0;
     inline bool is_vertice(const point<T> & p)const;
+    // Only segments registered in grid cell of point are tested, except for
+    // shapes with few segments which are scanned. Grid is built by first
+    // call, concurrent calls being safe
     inline bool is_on_border(const point<T> & p)const;
+    inline void is_on_border(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result)const;
+    inline const T & get_min_x(void)const;
+    inline const T & get_max_x(void)const;
+    inline const T & get_min_y(void)const;
+    inline const T & get_max_y(void)const;
     inline virtual ~shape(void){}
   protected:
     inline void internal_add(const point<T> & p_point);
-    inline void internal_add(const segment<T> & p_segment);
-    inline void remove_last_segment(void);
+    // Replace points by moving them in. Bounding box is computed in one pass
+    inline void internal_assign(std::vector<point<T>> && p_points);
+    // Update vertex index and drop border index once points have been added
+    inline void index_vertices(void);
+    // Linear time vertex indexation for points stored in convex hull order
+    inline void index_hull_vertices(void);
   private:
+    // Number of segments from which border index is built
+    static const uint32_t m_border_index_threshold = 32;
+    // Margin in cell units added around segments so that rounding cannot
+    // leave a cell crossed by a segment unregistered
+    static constexpr double m_border_epsilon = 1e-6;
+
+    inline void prepare_border(void)const;
+    inline void index_border(void)const;
+    inline void drop_border(void);
+    // Call p_function(cell index) for each border grid cell touched by
+    // segment
+    template <typename FUNCTION>
+    inline void for_each_border_cell(uint32_t p_index,FUNCTION p_function)const;
+    inline uint32_t get_border_cell(const point<T> & p)const;
+    inline static uint32_t clamp(double p_value,uint32_t p_size);
+    // Exact test without building segment
+    inline bool is_on_segment(uint32_t p_index,const point<T> & p)const;
+
     std::vector<point<T>> m_points;
-    std::vector<segment<T>> m_segments;
-    std::set<point<T>> m_sorted_points;
+    // Indexes of points sorted by point order
+    std::vector<uint32_t> m_sorted_indexes;
     T m_min_x;
     T m_max_x;
     T m_min_y;
     T m_max_y;
+
+    // Border index : grid over bounding box with about one cell per segment.
+    // Segments touching cell i are m_border_segments[m_border_cell_start[i]]
+    // to m_border_segments[m_border_cell_start[i + 1] - 1]. Flag is replaced
+    // when shape changes after index has been built
+    std::unique_ptr<std::once_flag> m_border_flag;
+    mutable bool m_border_built;
+    mutable uint32_t m_border_width;
+    mutable uint32_t m_border_height;
+    mutable double m_border_cell_width;
+    mutable double m_border_cell_height;
+    mutable std::vector<uint32_t> m_border_cell_start;
+    mutable std::vector<uint32_t> m_border_segments;
   };
 
+  template <typename T>
+  const uint32_t shape<T>::m_border_index_threshold;
+
+  template <typename T>
+  constexpr double shape<T>::m_border_epsilon;
+
   //----------------------------------------------------------------------------
   template <typename T> 
   std::ostream & operator<<(std::ostream & p_stream, const shape<T> & p_shape)
@@ -81,15 +138,58 @@ namespace geometry
     m_min_x(std::numeric_limits<T>::max()),
     m_max_x(std::numeric_limits<T>::lowest()),
     m_min_y(std::numeric_limits<T>::max()),
-    m_max_y(std::numeric_limits<T>::lowest())
+    m_max_y(std::numeric_limits<T>::lowest()),
+    m_border_flag(new std::once_flag()),
+    m_border_built(false),
+    m_border_width(0),
+    m_border_height(0),
+    m_border_cell_width(0),
+    m_border_cell_height(0)
+  {
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  shape<T>::shape(const shape<T> & p_shape):
+    m_points(p_shape.m_points),
+    m_sorted_indexes(p_shape.m_sorted_indexes),
+    m_min_x(p_shape.m_min_x),
+    m_max_x(p_shape.m_max_x),
+    m_min_y(p_shape.m_min_y),
+    m_max_y(p_shape.m_max_y),
+    m_border_flag(new std::once_flag()),
+    m_border_built(false),
+    m_border_width(0),
+    m_border_height(0),
+    m_border_cell_width(0),
+    m_border_cell_height(0)
+  {
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  shape<T> & shape<T>::operator=(const shape<T> & p_shape)
   {
+    if(this != &p_shape)
+      {
+        m_points = p_shape.m_points;
+        m_sorted_indexes = p_shape.m_sorted_indexes;
+        m_min_x = p_shape.m_min_x;
+        m_max_x = p_shape.m_max_x;
+        m_min_y = p_shape.m_min_y;
+        m_max_y = p_shape.m_max_y;
+        drop_border();
+      }
+    return *this;
   }
 
   //------------------------------------------------------------------------------
   template <typename T> 
   bool shape<T>::is_vertice(const point<T> & p)const
   {
-    return m_sorted_points.end() != m_sorted_points.find(p);
+    assert(m_sorted_indexes.size() == m_points.size());
+    auto l_iter = std::lower_bound(m_sorted_indexes.begin(),m_sorted_indexes.end(),p,[this](uint32_t p_index,const point<T> & p_point) -> bool { return m_points[p_index] < p_point; });
+    return m_sorted_indexes.end() != l_iter && m_points[*l_iter] == p;
   }
   //------------------------------------------------------------------------------
   template <typename T> 
@@ -99,16 +199,181 @@ namespace geometry
       {
         return true;
       }
-    for(auto l_iter: m_segments)
+    prepare_border();
+    if(m_border_cell_start.empty())
+      {
+        for(uint32_t l_index = 0 ; l_index < get_nb_segment() ; ++l_index)
+          {
+            if(is_on_segment(l_index,p))
+              {
+                return true;
+              }
+          }
+        return false;
+      }
+    if(p.get_x() < m_min_x || m_max_x < p.get_x() || p.get_y() < m_min_y || m_max_y < p.get_y())
+      {
+        return false;
+      }
+    uint32_t l_cell = get_border_cell(p);
+    for(uint32_t l_index = m_border_cell_start[l_cell] ; l_index < m_border_cell_start[l_cell + 1] ; ++l_index)
       {
-	if(l_iter.belong(p)) 
-	  {
-	    return true;
-	  }
+        if(is_on_segment(m_border_segments[l_index],p))
+          {
+            return true;
+          }
       }
     return false;
   }
 
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void shape<T>::is_on_border(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result)const
+  {
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = is_on_border(p_points[l_index]);
+      }
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  bool shape<T>::is_on_segment(uint32_t p_index,const point<T> & p)const
+  {
+    const point<T> & l_source = m_points[p_index];
+    const point<T> & l_dest = m_points[p_index + 1 < m_points.size() ? p_index + 1 : 0];
+    if(p.get_x() < std::min(l_source.get_x(),l_dest.get_x()) || std::max(l_source.get_x(),l_dest.get_x()) < p.get_x() ||
+       p.get_y() < std::min(l_source.get_y(),l_dest.get_y()) || std::max(l_source.get_y(),l_dest.get_y()) < p.get_y())
+      {
+        return false;
+      }
+    return !cross_product(l_dest.get_x() - l_source.get_x(),l_dest.get_y() - l_source.get_y(),p.get_x() - l_source.get_x(),p.get_y() - l_source.get_y());
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  uint32_t shape<T>::clamp(double p_value,uint32_t p_size)
+  {
+    return p_value < 0 ? 0 : (p_value >= p_size ? p_size - 1 : (uint32_t)p_value);
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  uint32_t shape<T>::get_border_cell(const point<T> & p)const
+  {
+    uint32_t l_column = clamp(((double)p.get_x() - (double)m_min_x) / m_border_cell_width,m_border_width);
+    uint32_t l_row = clamp(((double)p.get_y() - (double)m_min_y) / m_border_cell_height,m_border_height);
+    return l_row * m_border_width + l_column;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  template <typename FUNCTION>
+  void shape<T>::for_each_border_cell(uint32_t p_index,FUNCTION p_function)const
+  {
+    // Segment in cell units, cells touched being walked row by row
+    const point<T> & l_source = m_points[p_index];
+    const point<T> & l_dest = m_points[p_index + 1 < m_points.size() ? p_index + 1 : 0];
+    double l_u1 = ((double)l_source.get_x() - (double)m_min_x) / m_border_cell_width;
+    double l_v1 = ((double)l_source.get_y() - (double)m_min_y) / m_border_cell_height;
+    double l_u2 = ((double)l_dest.get_x() - (double)m_min_x) / m_border_cell_width;
+    double l_v2 = ((double)l_dest.get_y() - (double)m_min_y) / m_border_cell_height;
+    if(l_v2 < l_v1)
+      {
+        std::swap(l_u1,l_u2);
+        std::swap(l_v1,l_v2);
+      }
+    uint32_t l_last_row = clamp(l_v2 + m_border_epsilon,m_border_height);
+    for(uint32_t l_row = clamp(l_v1 - m_border_epsilon,m_border_height) ; l_row <= l_last_row ; ++l_row)
+      {
+        double l_low_u = l_u1;
+        double l_high_u = l_u2;
+        if(l_v2 > l_v1)
+          {
+            double l_low = std::max(l_v1,(double)l_row);
+            double l_high = std::min(l_v2,(double)l_row + 1);
+            l_low_u = l_u1 + (l_u2 - l_u1) * (l_low - l_v1) / (l_v2 - l_v1);
+            l_high_u = l_u1 + (l_u2 - l_u1) * (l_high - l_v1) / (l_v2 - l_v1);
+          }
+        uint32_t l_last_column = clamp(std::max(l_low_u,l_high_u) + m_border_epsilon,m_border_width);
+        for(uint32_t l_column = clamp(std::min(l_low_u,l_high_u) - m_border_epsilon,m_border_width) ; l_column <= l_last_column ; ++l_column)
+          {
+            p_function(l_row * m_border_width + l_column);
+          }
+      }
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void shape<T>::prepare_border(void)const
+  {
+    std::call_once(*m_border_flag,&shape<T>::index_border,this);
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void shape<T>::drop_border(void)
+  {
+    if(!m_border_built)
+      {
+        return;
+      }
+    m_border_flag.reset(new std::once_flag());
+    m_border_built = false;
+    m_border_cell_start.clear();
+    m_border_segments.clear();
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void shape<T>::index_border(void)const
+  {
+    m_border_built = true;
+    uint32_t l_nb_segment = get_nb_segment();
+    if(l_nb_segment < m_border_index_threshold)
+      {
+        return;
+      }
+    // Cells are as square as possible, flat bounding box giving a single
+    // row or column
+    double l_width = (double)m_max_x - (double)m_min_x;
+    double l_height = (double)m_max_y - (double)m_min_y;
+    if(!(l_height > 0))
+      {
+        m_border_width = l_nb_segment;
+      }
+    else if(!(l_width > 0))
+      {
+        m_border_width = 1;
+      }
+    else
+      {
+        m_border_width = std::min(l_nb_segment,std::max((uint32_t)1,(uint32_t)std::sqrt(l_nb_segment * l_width / l_height)));
+      }
+    m_border_height = std::max((uint32_t)1,l_nb_segment / m_border_width);
+    m_border_cell_width = l_width > 0 ? l_width / m_border_width : 1;
+    m_border_cell_height = l_height > 0 ? l_height / m_border_height : 1;
+
+    // Count segments per cell then fill cells
+    uint32_t l_nb_cell = m_border_width * m_border_height;
+    m_border_cell_start.assign(l_nb_cell + 1,0);
+    for(uint32_t l_index = 0 ; l_index < l_nb_segment ; ++l_index)
+      {
+        for_each_border_cell(l_index,[&](uint32_t p_cell) { ++m_border_cell_start[p_cell + 1]; });
+      }
+    for(uint32_t l_cell = 0 ; l_cell < l_nb_cell ; ++l_cell)
+      {
+        m_border_cell_start[l_cell + 1] += m_border_cell_start[l_cell];
+      }
+    m_border_segments.resize(m_border_cell_start[l_nb_cell]);
+    std::vector<uint32_t> l_position(m_border_cell_start.begin(),m_border_cell_start.end() - 1);
+    for(uint32_t l_index = 0 ; l_index < l_nb_segment ; ++l_index)
+      {
+        for_each_border_cell(l_index,[&](uint32_t p_cell) { m_border_segments[l_position[p_cell]++] = l_index; });
+      }
+  }
+
   //------------------------------------------------------------------------------
   template <typename T> 
   uint32_t shape<T>::get_nb_point(void)const
@@ -120,15 +385,15 @@ namespace geometry
   template <typename T> 
   uint32_t shape<T>::get_nb_segment(void)const
   {
-    return m_segments.size();
+    return m_points.size();
   }
 
   //------------------------------------------------------------------------------
   template <typename T> 
-  const segment<T> & shape<T>::get_segment(const uint32_t & p_index)const
+  segment<T> shape<T>::get_segment(const uint32_t & p_index)const
   {
-    assert(p_index < m_segments.size());
-    return m_segments[p_index];
+    assert(p_index < m_points.size());
+    return segment<T>(m_points[p_index],m_points[p_index + 1 < m_points.size() ? p_index + 1 : 0]);
   }
 
   //------------------------------------------------------------------------------
@@ -139,6 +404,34 @@ namespace geometry
     return m_points[p_index];
   }
 
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  const T & shape<T>::get_min_x(void)const
+  {
+    return m_min_x;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  const T & shape<T>::get_max_x(void)const
+  {
+    return m_max_x;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  const T & shape<T>::get_min_y(void)const
+  {
+    return m_min_y;
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  const T & shape<T>::get_max_y(void)const
+  {
+    return m_max_y;
+  }
+
   //------------------------------------------------------------------------------
   template <typename T> 
   void shape<T>::internal_add(const point<T> & p_point)
@@ -148,22 +441,88 @@ namespace geometry
     if(p_point.get_x() < m_min_x) m_min_x = p_point.get_x();
     if(p_point.get_y() < m_min_y) m_min_y = p_point.get_y();
     m_points.push_back(p_point);
-    m_sorted_points.insert(p_point);
   }
 
   //------------------------------------------------------------------------------
   template <typename T> 
-  void shape<T>::internal_add(const segment<T> & p_segment)
+  void shape<T>::internal_assign(std::vector<point<T>> && p_points)
   {
-    m_segments.push_back(p_segment);
+    m_points = std::move(p_points);
+    m_sorted_indexes.clear();
+    m_min_x = std::numeric_limits<T>::max();
+    m_max_x = std::numeric_limits<T>::lowest();
+    m_min_y = std::numeric_limits<T>::max();
+    m_max_y = std::numeric_limits<T>::lowest();
+    for(auto & l_iter : m_points)
+      {
+        if(l_iter.get_x() > m_max_x) m_max_x = l_iter.get_x();
+        if(l_iter.get_y() > m_max_y) m_max_y = l_iter.get_y();
+        if(l_iter.get_x() < m_min_x) m_min_x = l_iter.get_x();
+        if(l_iter.get_y() < m_min_y) m_min_y = l_iter.get_y();
+      }
   }
 
   //------------------------------------------------------------------------------
   template <typename T> 
-  void shape<T>::remove_last_segment(void)
+  void shape<T>::index_vertices(void)
   {
-    assert(m_segments.size());
-    m_segments.pop_back();
+    auto l_comparator = [this](uint32_t p_index1,uint32_t p_index2) -> bool { return m_points[p_index1] < m_points[p_index2]; };
+    if(m_sorted_indexes.size() + 1 == m_points.size())
+      {
+        // Single point added since last indexation
+        uint32_t l_index = m_points.size() - 1;
+        m_sorted_indexes.insert(std::upper_bound(m_sorted_indexes.begin(),m_sorted_indexes.end(),l_index,l_comparator),l_index);
+        drop_border();
+        return;
+      }
+    m_sorted_indexes.resize(m_points.size());
+    for(uint32_t l_index = 0 ; l_index < m_points.size() ; ++l_index)
+      {
+        m_sorted_indexes[l_index] = l_index;
+      }
+    std::sort(m_sorted_indexes.begin(),m_sorted_indexes.end(),l_comparator);
+    drop_border();
+  }
+
+  //------------------------------------------------------------------------------
+  template <typename T> 
+  void shape<T>::index_hull_vertices(void)
+  {
+    // Minimum and maximum points split hull in two chains already sorted
+    // from minimum to maximum : one walked by increasing indexes, the other
+    // by decreasing indexes. Sorted indexes are the merge of both chains
+    uint32_t l_nb_point = m_points.size();
+    assert(l_nb_point);
+    uint32_t l_min = 0;
+    uint32_t l_max = 0;
+    for(uint32_t l_index = 1 ; l_index < l_nb_point ; ++l_index)
+      {
+        if(m_points[l_index] < m_points[l_min]) l_min = l_index;
+        if(m_points[l_max] < m_points[l_index]) l_max = l_index;
+      }
+    uint32_t l_nb_forward = (l_max + l_nb_point - l_min) % l_nb_point;
+    uint32_t l_nb_backward = l_nb_point - 1 - l_nb_forward;
+    uint32_t l_forward = (l_min + 1) % l_nb_point;
+    uint32_t l_backward = (l_min + l_nb_point - 1) % l_nb_point;
+    m_sorted_indexes.resize(l_nb_point);
+    m_sorted_indexes[0] = l_min;
+    for(uint32_t l_index = 1 ; l_index < l_nb_point ; ++l_index)
+      {
+        if(l_nb_forward && (!l_nb_backward || m_points[l_forward] < m_points[l_backward]))
+          {
+            m_sorted_indexes[l_index] = l_forward;
+            l_forward = (l_forward + 1) % l_nb_point;
+            --l_nb_forward;
+          }
+        else
+          {
+            m_sorted_indexes[l_index] = l_backward;
+            l_backward = (l_backward + l_nb_point - 1) % l_nb_point;
+            --l_nb_backward;
+          }
+      }
+    assert(std::is_sorted(m_sorted_indexes.begin(),m_sorted_indexes.end(),[this](uint32_t p_index1,uint32_t p_index2) -> bool { return m_points[p_index1] < m_points[p_index2]; }));
+    drop_border();
   }
 
   //------------------------------------------------------------------------------
@@ -0,0 +1,328 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+#ifndef _SLAB_DECOMPOSITION_HPP_
+#define _SLAB_DECOMPOSITION_HPP_
+
+#include "point.hpp"
+#include "polygon.hpp"
+#include "arithmetic_traits.hpp"
+#include "geometry_stats.hpp"
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cinttypes>
+#include <cassert>
+
+namespace geometry
+{
+  // Prepared polygon answering contains with two binary searches. Vertical
+  // lines through vertices cut plane in slabs, edges crossing a slab do not
+  // cross each other inside it so they are stored sorted from bottom to top.
+  // A point is inside polygon if it is above an odd number of edges of its
+  // slab. Points lying on a slab boundary are checked against vertices and
+  // vertical edges of this line.
+  // Memory is the total number of edges crossing slabs, which is O(n^2) in
+  // the worst case : this mode trades memory for query time. Polygon does not
+  // need to be cut in convex polygons. Decomposition is immutable : queries
+  // can be shared between threads
+  template <typename T=double>
+  class slab_decomposition
+  {
+  public:
+    inline slab_decomposition(const polygon<T> & p_polygon);
+    inline bool contains(const point<T> & p,bool p_consider_line=true)const;
+    inline void contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line=true)const;
+    inline uint32_t get_nb_slab(void)const;
+    // Total number of edges stored in slabs
+    inline uint32_t get_nb_slab_edge(void)const;
+  private:
+    // Non vertical edges going from left to right do not cross so they are
+    // ordered from bottom to top over the x range they share
+    class edge_below
+    {
+    public:
+      inline edge_below(const slab_decomposition<T> & p_decomposition);
+      inline bool operator()(uint32_t p_edge1,uint32_t p_edge2)const;
+    private:
+      const slab_decomposition<T> * m_decomposition;
+    };
+
+    // Sign of vectorial product between edge and vector going from edge left
+    // end to point : positive when point is above edge
+    inline int get_side(uint32_t p_edge,const T & p_x,const T & p_y)const;
+
+    T m_min_x;
+    T m_max_x;
+    T m_min_y;
+    T m_max_y;
+
+    // Non vertical edges stored from left end to right end
+    std::vector<T> m_x;
+    std::vector<T> m_y;
+    std::vector<T> m_coef_x;
+    std::vector<T> m_coef_y;
+
+    // Slab i goes from m_slab_x[i] to m_slab_x[i + 1], its edges being
+    // m_slab_edges[m_slab_first[i]] to m_slab_edges[m_slab_first[i + 1] - 1]
+    std::vector<T> m_slab_x;
+    std::vector<uint32_t> m_slab_first;
+    std::vector<uint32_t> m_slab_edges;
+
+    // Vertices and vertical edges lying on line x = m_slab_x[i], merged in
+    // disjoint y intervals sorted by y : intervals m_line_first[i] to
+    // m_line_first[i + 1] - 1
+    std::vector<uint32_t> m_line_first;
+    std::vector<T> m_line_min_y;
+    std::vector<T> m_line_max_y;
+  };
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  slab_decomposition<T>::edge_below::edge_below(const slab_decomposition<T> & p_decomposition):
+    m_decomposition(&p_decomposition)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool slab_decomposition<T>::edge_below::operator()(uint32_t p_edge1,uint32_t p_edge2)const
+  {
+    if(p_edge1 == p_edge2)
+      {
+        return false;
+      }
+    // Compare one end of the edge starting last with the other edge, this
+    // end being inside the x range of both edges
+    const slab_decomposition<T> & l_decomposition = *m_decomposition;
+    bool l_first_later = l_decomposition.m_x[p_edge1] >= l_decomposition.m_x[p_edge2];
+    uint32_t l_later = l_first_later ? p_edge1 : p_edge2;
+    uint32_t l_other = l_first_later ? p_edge2 : p_edge1;
+    int l_side = l_decomposition.get_side(l_other,l_decomposition.m_x[l_later],l_decomposition.m_y[l_later]);
+    if(!l_side)
+      {
+        l_side = l_decomposition.get_side(l_other,l_decomposition.m_x[l_later] + l_decomposition.m_coef_x[l_later],l_decomposition.m_y[l_later] + l_decomposition.m_coef_y[l_later]);
+      }
+    if(!l_side)
+      {
+        return p_edge1 < p_edge2;
+      }
+    return l_first_later ? l_side < 0 : l_side > 0;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  int slab_decomposition<T>::get_side(uint32_t p_edge,const T & p_x,const T & p_y)const
+  {
+    return get_sign(cross_product(m_coef_x[p_edge],m_coef_y[p_edge],p_x - m_x[p_edge],p_y - m_y[p_edge]));
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  slab_decomposition<T>::slab_decomposition(const polygon<T> & p_polygon):
+    m_min_x(p_polygon.get_min_x()),
+    m_max_x(p_polygon.get_max_x()),
+    m_min_y(p_polygon.get_min_y()),
+    m_max_y(p_polygon.get_max_y())
+  {
+    uint32_t l_nb_point = p_polygon.get_nb_point();
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        m_slab_x.push_back(p_polygon.get_point(l_index).get_x());
+      }
+    std::sort(m_slab_x.begin(),m_slab_x.end());
+    m_slab_x.erase(std::unique(m_slab_x.begin(),m_slab_x.end()),m_slab_x.end());
+    auto l_line = [&](const T & p_x) -> uint32_t
+      {
+        return std::lower_bound(m_slab_x.begin(),m_slab_x.end(),p_x) - m_slab_x.begin();
+      };
+
+    // Split edges between slab edges and line intervals, vertices being
+    // degenerated intervals
+    uint32_t l_nb_line = m_slab_x.size();
+    std::vector<uint32_t> l_interval_lines;
+    std::vector<T> l_interval_min_y;
+    std::vector<T> l_interval_max_y;
+    std::vector<uint32_t> l_first_line;
+    std::vector<uint32_t> l_last_line;
+    for(uint32_t l_index = 0 ; l_index < l_nb_point ; ++l_index)
+      {
+        const point<T> & l_source = p_polygon.get_point(l_index);
+        const point<T> & l_dest = p_polygon.get_point(l_index + 1 < l_nb_point ? l_index + 1 : 0);
+        l_interval_lines.push_back(l_line(l_source.get_x()));
+        l_interval_min_y.push_back(l_source.get_y());
+        l_interval_max_y.push_back(l_source.get_y());
+        if(l_source.get_x() == l_dest.get_x())
+          {
+            l_interval_lines.push_back(l_interval_lines.back());
+            l_interval_min_y.push_back(std::min(l_source.get_y(),l_dest.get_y()));
+            l_interval_max_y.push_back(std::max(l_source.get_y(),l_dest.get_y()));
+            continue;
+          }
+        const point<T> & l_left = l_source.get_x() < l_dest.get_x() ? l_source : l_dest;
+        const point<T> & l_right = l_source.get_x() < l_dest.get_x() ? l_dest : l_source;
+        m_x.push_back(l_left.get_x());
+        m_y.push_back(l_left.get_y());
+        m_coef_x.push_back(l_right.get_x() - l_left.get_x());
+        m_coef_y.push_back(l_right.get_y() - l_left.get_y());
+        l_first_line.push_back(l_line(l_left.get_x()));
+        l_last_line.push_back(l_line(l_right.get_x()));
+      }
+
+    // Line intervals sorted by line then by y and merged when they overlap
+    std::vector<uint32_t> l_order(l_interval_lines.size());
+    for(uint32_t l_index = 0 ; l_index < l_order.size() ; ++l_index)
+      {
+        l_order[l_index] = l_index;
+      }
+    std::sort(l_order.begin(),l_order.end(),[&](uint32_t p_index1,uint32_t p_index2) -> bool
+              {
+                return l_interval_lines[p_index1] != l_interval_lines[p_index2] ? l_interval_lines[p_index1] < l_interval_lines[p_index2] : l_interval_min_y[p_index1] < l_interval_min_y[p_index2];
+              });
+    m_line_first.assign(l_nb_line + 1,0);
+    uint32_t l_previous_line = l_nb_line;
+    for(auto l_index : l_order)
+      {
+        uint32_t l_current_line = l_interval_lines[l_index];
+        if(l_current_line == l_previous_line && !(m_line_max_y.back() < l_interval_min_y[l_index]))
+          {
+            m_line_max_y.back() = std::max(m_line_max_y.back(),l_interval_max_y[l_index]);
+            continue;
+          }
+        m_line_min_y.push_back(l_interval_min_y[l_index]);
+        m_line_max_y.push_back(l_interval_max_y[l_index]);
+        ++m_line_first[l_current_line + 1];
+        l_previous_line = l_current_line;
+      }
+    for(uint32_t l_index = 1 ; l_index <= l_nb_line ; ++l_index)
+      {
+        m_line_first[l_index] += m_line_first[l_index - 1];
+      }
+
+    // Sweep lines from left to right keeping edges crossing current slab
+    // ordered from bottom to top
+    uint32_t l_nb_edge = m_x.size();
+    std::vector<uint32_t> l_by_first(l_nb_edge);
+    std::vector<uint32_t> l_by_last(l_nb_edge);
+    for(uint32_t l_index = 0 ; l_index < l_nb_edge ; ++l_index)
+      {
+        l_by_first[l_index] = l_by_last[l_index] = l_index;
+      }
+    std::sort(l_by_first.begin(),l_by_first.end(),[&](uint32_t p_index1,uint32_t p_index2) -> bool { return l_first_line[p_index1] < l_first_line[p_index2]; });
+    std::sort(l_by_last.begin(),l_by_last.end(),[&](uint32_t p_index1,uint32_t p_index2) -> bool { return l_last_line[p_index1] < l_last_line[p_index2]; });
+    std::set<uint32_t,edge_below> l_status{edge_below(*this)};
+    uint32_t l_nb_slab = l_nb_line ? l_nb_line - 1 : 0;
+    m_slab_first.assign(1,0);
+    m_slab_first.reserve(l_nb_slab + 1);
+    auto l_first_iter = l_by_first.begin();
+    auto l_last_iter = l_by_last.begin();
+    for(uint32_t l_slab = 0 ; l_slab < l_nb_slab ; ++l_slab)
+      {
+        while(l_by_last.end() != l_last_iter && l_last_line[*l_last_iter] == l_slab)
+          {
+            l_status.erase(*l_last_iter);
+            ++l_last_iter;
+          }
+        while(l_by_first.end() != l_first_iter && l_first_line[*l_first_iter] == l_slab)
+          {
+            l_status.insert(*l_first_iter);
+            ++l_first_iter;
+          }
+        m_slab_edges.insert(m_slab_edges.end(),l_status.begin(),l_status.end());
+        m_slab_first.push_back(m_slab_edges.size());
+      }
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t slab_decomposition<T>::get_nb_slab(void)const
+  {
+    return m_slab_first.size() - 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t slab_decomposition<T>::get_nb_slab_edge(void)const
+  {
+    return m_slab_edges.size();
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  bool slab_decomposition<T>::contains(const point<T> & p,bool p_consider_line)const
+  {
+    GEOMETRY_STATS_SCOPE(CONTAINS);
+    if(p.get_x() < m_min_x || m_max_x < p.get_x() || p.get_y() < m_min_y || m_max_y < p.get_y())
+      {
+        GEOMETRY_STATS_ADD(BBOX_REJECTION,1);
+        return false;
+      }
+
+    // Slab whose left line is the last one not after point
+    uint32_t l_slab = std::upper_bound(m_slab_x.begin(),m_slab_x.end(),p.get_x()) - m_slab_x.begin() - 1;
+    if(p.get_x() == m_slab_x[l_slab])
+      {
+        auto l_begin = m_line_max_y.begin() + m_line_first[l_slab];
+        auto l_end = m_line_max_y.begin() + m_line_first[l_slab + 1];
+        auto l_iter = std::lower_bound(l_begin,l_end,p.get_y());
+        if(l_end != l_iter && !(p.get_y() < m_line_min_y[l_iter - m_line_max_y.begin()]))
+          {
+            return p_consider_line;
+          }
+        if(l_slab + 1 == m_slab_x.size())
+          {
+            return false;
+          }
+      }
+
+    // Number of edges below point
+    const uint32_t * l_edges = m_slab_edges.data() + m_slab_first[l_slab];
+    uint32_t l_low = 0;
+    uint32_t l_high = m_slab_first[l_slab + 1] - m_slab_first[l_slab];
+    while(l_low < l_high)
+      {
+        GEOMETRY_STATS_ADD(EDGE_TEST,1);
+        uint32_t l_middle = l_low + (l_high - l_low) / 2;
+        if(get_side(l_edges[l_middle],p.get_x(),p.get_y()) > 0)
+          {
+            l_low = l_middle + 1;
+          }
+        else
+          {
+            l_high = l_middle;
+          }
+      }
+    if(l_low < m_slab_first[l_slab + 1] - m_slab_first[l_slab] && !get_side(l_edges[l_low],p.get_x(),p.get_y()))
+      {
+        return p_consider_line;
+      }
+    return l_low & 1;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  void slab_decomposition<T>::contains(const point<T> * p_points,uint32_t p_nb_point,std::vector<bool> & p_result,bool p_consider_line)const
+  {
+    p_result.resize(p_nb_point);
+    for(uint32_t l_index = 0 ; l_index < p_nb_point ; ++l_index)
+      {
+        p_result[l_index] = contains(p_points[l_index],p_consider_line);
+      }
+  }
+}
+#endif // _SLAB_DECOMPOSITION_HPP_
+//EOF
@@ -0,0 +1,100 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+// Regression tests of convex shapes intersection when shapes share vertices.
+// Build : g++ -std=c++11 -O2 -I../include convex_operations_test.cpp
+// Usage : convex_operations_test
+// Exit status is not null if a check failed
+#include "convex_operations.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <cinttypes>
+
+namespace convex_operations_test
+{
+  typedef geometry::point<double> t_point;
+
+  //----------------------------------------------------------------------------
+  inline double get_area(const std::vector<t_point> & p_points)
+  {
+    double l_double_area = 0;
+    for(uint32_t l_index = 0 ; l_index < p_points.size() ; ++l_index)
+      {
+        const t_point & l_current = p_points[l_index];
+        const t_point & l_next = p_points[(l_index + 1) % p_points.size()];
+        l_double_area += l_current.get_x() * l_next.get_y() - l_next.get_x() * l_current.get_y();
+      }
+    return l_double_area / 2;
+  }
+
+  //----------------------------------------------------------------------------
+  // Intersection area must not depend on walk starting vertices nor on
+  // shapes order
+  inline uint32_t check(const std::string & p_name,const std::vector<t_point> & p_points1,const std::vector<t_point> & p_points2,double p_expected_area)
+  {
+    uint32_t l_nb_failure = 0;
+    for(uint32_t l_start1 = 0 ; l_start1 < p_points1.size() ; ++l_start1)
+      {
+        for(uint32_t l_start2 = 0 ; l_start2 < p_points2.size() ; ++l_start2)
+          {
+            std::vector<t_point> l_points1(p_points1);
+            std::vector<t_point> l_points2(p_points2);
+            std::rotate(l_points1.begin(),l_points1.begin() + l_start1,l_points1.end());
+            std::rotate(l_points2.begin(),l_points2.begin() + l_start2,l_points2.end());
+            geometry::convex_shape<double> l_shape1(l_points1);
+            geometry::convex_shape<double> l_shape2(l_points2);
+            for(uint32_t l_swap = 0 ; l_swap < 2 ; ++l_swap)
+              {
+                const geometry::convex_shape<double> & l_first = l_swap ? l_shape2 : l_shape1;
+                const geometry::convex_shape<double> & l_second = l_swap ? l_shape1 : l_shape2;
+                std::vector<t_point> l_result;
+                bool l_found = geometry::convex_operations<double>::intersection(l_first,l_second,l_result);
+                double l_area = geometry::convex_operations<double>::intersection_area(l_first,l_second);
+                if(!l_found || std::fabs(get_area(l_result) - p_expected_area) > 1e-9 || std::fabs(l_area - p_expected_area) > 1e-9)
+                  {
+                    std::cout << p_name << " failed : start " << l_start1 << "," << l_start2 << " swap " << l_swap << " area " << l_area << " instead of " << p_expected_area << std::endl;
+                    ++l_nb_failure;
+                  }
+              }
+          }
+      }
+    return l_nb_failure;
+  }
+}
+
+//------------------------------------------------------------------------------
+int main(void)
+{
+  typedef convex_operations_test::t_point t_point;
+  uint32_t l_nb_failure = 0;
+  // Shapes sharing a vertex, boundaries also crossing properly
+  l_nb_failure += convex_operations_test::check("shared_vertex",
+                                                {t_point(0,4),t_point(3,0),t_point(7,4),t_point(7,5),t_point(0,5)},
+                                                {t_point(0,5),t_point(2,2),t_point(6,4),t_point(0,8)},
+                                                41.0 / 4);
+  // Shared vertex followed by a vertex inside the other shape
+  l_nb_failure += convex_operations_test::check("shared_vertex_inner",
+                                                {t_point(2,0),t_point(5,1),t_point(7,4),t_point(8,7),t_point(6,7),t_point(2,2)},
+                                                {t_point(2,2),t_point(6,3),t_point(8,5),t_point(7,6),t_point(2,7)},
+                                                631.0 / 58);
+  std::cout << (l_nb_failure ? "FAILED" : "OK") << std::endl;
+  return l_nb_failure != 0;
+}
+//EOF
@@ -0,0 +1,217 @@
+/*
+  This file is part of geometry
+  Copyright (C) 2011  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+// Concurrent containment queries on a polygon shared by query_executor
+// workers. Polygon is not prepared beforehand so that workers race on its
+// lazy preparation. Results are compared with single threaded contains on
+// another instance.
+// Build : g++ -std=c++11 -O2 -I../include query_executor_test.cpp -pthread
+// Usage : query_executor_test [nb_round]
+// Exit status is not null if a check failed
+#include "polygon.hpp"
+#include "polygon_generator.hpp"
+#include "query_executor.hpp"
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+#include <cinttypes>
+
+namespace query_executor_test
+{
+  // Deterministic pseudo random sequence so that runs are reproducible
+  class lcg
+  {
+  public:
+    inline lcg(uint64_t p_seed):
+      m_state(p_seed)
+    {
+    }
+
+    inline double next(void)
+    {
+      m_state = m_state * 6364136223846793005ULL + 1442695040888963407ULL;
+      return (m_state >> 11) * (1.0 / 9007199254740992.0);
+    }
+  private:
+    uint64_t m_state;
+  };
+
+  //----------------------------------------------------------------------------
+  // Random points around bounding box followed by polygon vertices, which
+  // are on border
+  template <typename T>
+  std::vector<geometry::point<T>> get_queries(const std::vector<geometry::point<T>> & p_vertices,uint32_t p_nb_query)
+  {
+    geometry::polygon<T> l_polygon(p_vertices);
+    double l_min_x = l_polygon.get_min_x();
+    double l_min_y = l_polygon.get_min_y();
+    double l_width = (double)l_polygon.get_max_x() - l_min_x;
+    double l_height = (double)l_polygon.get_max_y() - l_min_y;
+    lcg l_random(p_vertices.size());
+    std::vector<geometry::point<T>> l_queries;
+    l_queries.reserve(p_nb_query + p_vertices.size());
+    for(uint32_t l_index = 0 ; l_index < p_nb_query ; ++l_index)
+      {
+        double l_x = l_min_x + (1.2 * l_random.next() - 0.1) * l_width;
+        double l_y = l_min_y + (1.2 * l_random.next() - 0.1) * l_height;
+        l_queries.push_back(geometry::point<T>((T)l_x,(T)l_y));
+      }
+    l_queries.insert(l_queries.end(),p_vertices.begin(),p_vertices.end());
+    return l_queries;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t check(const std::string & p_type,const std::string & p_shape,const std::vector<geometry::point<T>> & p_vertices,uint32_t p_nb_round)
+  {
+    std::vector<geometry::point<T>> l_queries = get_queries(p_vertices,20000);
+    uint32_t l_nb_query = l_queries.size();
+
+    // Reference computed by calling thread alone
+    geometry::polygon<T> l_reference_polygon(p_vertices);
+    std::vector<uint8_t> l_reference(l_nb_query);
+    for(uint32_t l_index = 0 ; l_index < l_nb_query ; ++l_index)
+      {
+        l_reference[l_index] = l_reference_polygon.contains(l_queries[l_index]);
+      }
+
+    uint32_t l_nb_failure = 0;
+    const uint32_t l_nb_threads[] = {2,4,8};
+    for(uint32_t l_nb_thread : l_nb_threads)
+      {
+        geometry::query_executor<T,geometry::polygon<T>> l_executor(l_nb_thread);
+        for(uint32_t l_round = 0 ; l_round < p_nb_round ; ++l_round)
+          {
+            // Fresh polygon : first batch prepares it from all workers,
+            // second one queries it once prepared
+            geometry::polygon<T> l_polygon(p_vertices);
+            for(uint32_t l_batch = 0 ; l_batch < 2 ; ++l_batch)
+              {
+                std::vector<uint8_t> l_result;
+                l_executor.contains(l_polygon,l_queries.data(),l_nb_query,l_result);
+                uint32_t l_nb_mismatch = 0;
+                for(uint32_t l_index = 0 ; l_index < l_nb_query ; ++l_index)
+                  {
+                    l_nb_mismatch += l_result[l_index] != l_reference[l_index];
+                  }
+                if(l_nb_mismatch)
+                  {
+                    std::cout << p_type << " " << p_shape << " failed : " << l_nb_thread << " threads, round " << l_round << ", batch " << l_batch << ", " << l_nb_mismatch << " mismatches" << std::endl;
+                    ++l_nb_failure;
+                  }
+              }
+          }
+      }
+    return l_nb_failure;
+  }
+
+  //----------------------------------------------------------------------------
+  // Shape throwing on one point to check that exception reaches caller once
+  // workers are done and that executor remains usable afterwards
+  class throwing_shape
+  {
+  public:
+    inline throwing_shape(uint32_t p_throw_index):
+      m_throw_index(p_throw_index)
+    {
+    }
+
+    inline bool contains(const geometry::point<double> & p,bool p_consider_line)const
+    {
+      if((uint32_t)p.get_x() == m_throw_index)
+        {
+          throw std::runtime_error("throwing_shape");
+        }
+      return ((uint32_t)p.get_x()) & 1;
+    }
+  private:
+    uint32_t m_throw_index;
+  };
+
+  //----------------------------------------------------------------------------
+  inline uint32_t check_exception(void)
+  {
+    uint32_t l_nb_query = 100000;
+    std::vector<geometry::point<double>> l_queries;
+    for(uint32_t l_index = 0 ; l_index < l_nb_query ; ++l_index)
+      {
+        l_queries.push_back(geometry::point<double>(l_index,0));
+      }
+    uint32_t l_nb_failure = 0;
+    const uint32_t l_nb_threads[] = {1,2,4,8};
+    for(uint32_t l_nb_thread : l_nb_threads)
+      {
+        geometry::query_executor<double,throwing_shape> l_executor(l_nb_thread);
+        for(uint32_t l_throw_index : {0u,58u * 1024u + 7u,l_nb_query - 1})
+          {
+            throwing_shape l_shape(l_throw_index);
+            std::vector<uint8_t> l_result;
+            bool l_thrown = false;
+            try
+              {
+                l_executor.contains(l_shape,l_queries.data(),l_nb_query,l_result);
+              }
+            catch(const std::runtime_error &)
+              {
+                l_thrown = true;
+              }
+            // Next batch must run normally
+            throwing_shape l_safe_shape(l_nb_query);
+            l_executor.contains(l_safe_shape,l_queries.data(),l_nb_query,l_result);
+            uint32_t l_nb_mismatch = 0;
+            for(uint32_t l_index = 0 ; l_index < l_nb_query ; ++l_index)
+              {
+                l_nb_mismatch += l_result[l_index] != (l_index & 1);
+              }
+            if(!l_thrown || l_nb_mismatch)
+              {
+                std::cout << "exception failed : " << l_nb_thread << " threads, throw index " << l_throw_index << (l_thrown ? "" : ", not thrown") << ", " << l_nb_mismatch << " mismatches" << std::endl;
+                ++l_nb_failure;
+              }
+          }
+      }
+    return l_nb_failure;
+  }
+
+  //----------------------------------------------------------------------------
+  template <typename T>
+  uint32_t check_type(const std::string & p_type,uint32_t p_nb_round)
+  {
+    typedef geometry::polygon_generator<T> t_generator;
+    uint32_t l_nb_failure = 0;
+    l_nb_failure += check<T>(p_type,std::string("star"),t_generator::star(2000,1e6),p_nb_round);
+    l_nb_failure += check<T>(p_type,std::string("comb"),t_generator::comb(2000,16,1e5),p_nb_round);
+    l_nb_failure += check<T>(p_type,std::string("spiral"),t_generator::spiral(2000,16,1e6),p_nb_round);
+    l_nb_failure += check<T>(p_type,std::string("nested"),t_generator::nested(500,16),p_nb_round);
+    return l_nb_failure;
+  }
+}
+
+//------------------------------------------------------------------------------
+int main(int argc,char ** argv)
+{
+  uint32_t l_nb_round = argc > 1 ? strtoul(argv[1],NULL,0) : 4;
+  uint32_t l_nb_failure = 0;
+  l_nb_failure += query_executor_test::check_type<int32_t>(std::string("int"),l_nb_round);
+  l_nb_failure += query_executor_test::check_type<double>(std::string("double"),l_nb_round);
+  l_nb_failure += query_executor_test::check_exception();
+  std::cout << (l_nb_failure ? "FAILED" : "OK") << std::endl;
+  return l_nb_failure != 0;
+}
+//EOF